@@ -0,0 +1,467 @@
+//----------------------------------------------------------------------------
+// Module: avalon_multicore_wrapper
+// Description: Avalon Memory-Mapped Slave wrapper for N_CORES matrix multiplier
+//              cores ('top' instances) behind one slave, with a job dispatcher.
+//
+//              Operands live in each core's A/B BRAMs, so a job is bound to a
+//              core when its operands are loaded: the dispatcher always offers
+//              a "staging" core (one being loaded, else an idle one, else the
+//              lowest core holding an old result) and routes the A/B load
+//              writes to it. Submitting a job pushes a descriptor {core,
+//              partition, precision} onto a shared queue; the dispatcher pops one
+//              descriptor per cycle and holds that core's start_mult high
+//              until the result is released. While earlier jobs run, the host
+//              loads and submits the next ones on other cores.
+//
+// Register Map (addresses 0-7 behave as in avalon_wrapper):
+// Address 0 (Write): Control Register
+//   [0]: submit the staged job (with [1] high)
+//   [1]: reset (pulse low to reset every core and the dispatcher)
+//   [PREC_WIDTH+1:2]: job precision (bit-serial cores only, 0 = DATA_WIDTH)
+//   [PREC_WIDTH+2]: job partition flag (batch of jobs on the PE regions)
+// Address 1 (Read): Status Register
+//   [0]: mult_done of the most recently submitted job
+// Address 2 (Write): C BRAM Read Address
+//   [ADDR_WIDTH_C-1:0]: read_addr_c (Address in flattened C BRAM of the read core)
+// Address 3 (Read): C BRAM Read Data of the read core
+//   [ACC_WIDTH-1:0]: dout_c
+// Address 4-7 (Write): A/B BRAM Load Address/Data, routed to the staging core
+// Address 8 (Read): Capabilities
+//   [7:0]: N_CORES, [15:8]: QUEUE_DEPTH
+// Address 9 (Read): Per-core completion status (bit c: core c holds a result)
+//           (Write): Release mask (bit c: core c's result has been read, core is idle again)
+// Address 10 (Read/Write): Read core (C reads come from it; set to the core of each submitted job)
+// Address 11 (Read): Staging core
+//   [CORE_IDX_WIDTH-1:0]: core that the next loads go to, [CORE_IDX_WIDTH]: valid
+// Address 12 (Read/Write): Interrupt enable mask (bit c: core c completion)
+//
+// Interrupt: irq is high while any enabled core holds an unreleased result.
+//
+// A host written for avalon_wrapper (load, submit, poll address 1, read C)
+// keeps working unchanged: with no core idle, the staging core reclaims the
+// lowest completed core, whose result that host has already read.
+//----------------------------------------------------------------------------
+module avalon_multicore_wrapper
+  #(
+    parameter DATA_WIDTH = 16,
+    parameter M = 3,
+    parameter K = 3,
+    parameter N = 3,
+    parameter N_BANKS = 3,
+    parameter PE_ROWS = M,
+    parameter PE_COLS = N,
+    parameter PE_BIT_SERIAL = 0,     // 1: bit-serial cores, job precision from the control register
+    parameter PE_PART_ROWS = 1,      // PE regions for partitioned jobs (control register partition bit)
+    parameter PE_PART_COLS = 1,
+    parameter N_CORES = 2,           // Number of 'top' cores
+    parameter QUEUE_DEPTH = N_CORES, // Job descriptor queue entries
+    // ID_WIDTH needs to be wide enough for all defined addresses (0-12 -> 4 bits)
+    parameter ID_WIDTH = 4
+    )
+   (
+    // Avalon MM Slave Ports
+    input wire                                                clk,
+    input wire                                                reset_n,    // Asynchronous active-low reset
+    input wire [ID_WIDTH-1:0]                                 address,
+    input wire                                                chipselect,
+    input wire                                                read,
+    input wire                                                write,
+    input wire [N_BANKS * DATA_WIDTH - 1:0]                   writedata,
+    output reg [DATA_WIDTH * 2 + ((K > 1) ? $clog2(K) : 1):0] readdata,
+    output wire                                               waitrequest,
+    output wire                                               irq         // Combined completion interrupt
+    );
+
+   // Derived Parameters (matching top module/datapath/controller)
+   localparam DATA_IN_WIDTH = N_BANKS * DATA_WIDTH;
+   localparam ADDR_BUS_A = N_BANKS * ($clog2(N_BANKS) + (((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K) : 1));
+   localparam ADDR_BUS_B = N_BANKS * ($clog2(N_BANKS) + ((K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1));
+   localparam ADDR_WIDTH_C = (M * N > 0) ? $clog2(M * N) : 1;
+   localparam ACC_WIDTH_PE = DATA_WIDTH * 2 + ((K > 1) ? $clog2(K) : 1); // PE accumulator width must match
+   localparam PREC_WIDTH = $clog2(DATA_WIDTH+1); // Width of the precision field
+   localparam CTRL_WIDTH = PREC_WIDTH + 3; // Control register bits in use (see register map)
+   localparam CORE_IDX_WIDTH = (N_CORES > 1) ? $clog2(N_CORES) : 1;
+   localparam QUEUE_PTR_WIDTH = (QUEUE_DEPTH > 1) ? $clog2(QUEUE_DEPTH) : 1;
+   localparam QUEUE_CNT_WIDTH = $clog2(QUEUE_DEPTH+1);
+   localparam [7:0] CAP_CORES = N_CORES;     // Capability register fields
+   localparam [7:0] CAP_QUEUE = QUEUE_DEPTH;
+
+   // Core states
+   localparam [2:0]
+                    CORE_FREE    = 3'd0, // Idle, no result held
+                    CORE_STAGED  = 3'd1, // Operands being loaded for the next job
+                    CORE_QUEUED  = 3'd2, // Job submitted, descriptor in the queue
+                    CORE_RUNNING = 3'd3, // start_mult held high, multiplication in progress
+                    CORE_DONE    = 3'd4; // Result held until released (start_mult still high)
+
+   reg [2:0]                        core_state[N_CORES-1:0];
+   reg [N_CORES-1:0]                core_start;     // start_mult of each core
+   reg [N_CORES*PREC_WIDTH-1:0]     core_precision; // Precision of each core's current job
+   reg [N_CORES-1:0]                core_partition; // Partition flag of each core's current job
+   wire [N_CORES-1:0]               core_done;      // mult_done of each core
+   wire [N_CORES*ACC_WIDTH_PE-1:0]  core_dout_c;    // dout_c of each core
+   reg [N_CORES-1:0]                done_mask;      // Cores holding a result (CORE_DONE)
+
+   // Job descriptor queue: {core, partition, precision}
+   reg [CORE_IDX_WIDTH+PREC_WIDTH:0]   queue[QUEUE_DEPTH-1:0];
+   reg [QUEUE_PTR_WIDTH-1:0]           queue_wr_ptr;
+   reg [QUEUE_PTR_WIDTH-1:0]           queue_rd_ptr;
+   reg [QUEUE_CNT_WIDTH-1:0]           queue_count;
+   wire                                queue_full = (queue_count == QUEUE_DEPTH);
+   wire [CORE_IDX_WIDTH-1:0]           head_core = queue[queue_rd_ptr][CORE_IDX_WIDTH+PREC_WIDTH:PREC_WIDTH+1];
+   wire                                head_partition = queue[queue_rd_ptr][PREC_WIDTH];
+   wire [PREC_WIDTH-1:0]               head_precision = queue[queue_rd_ptr][PREC_WIDTH-1:0];
+   wire                                dispatch = (queue_count != 0); // Head core is always idle (CORE_QUEUED)
+
+   // Staging core selection: a core being loaded, else the lowest free core,
+   // else the lowest core holding a result
+   reg [CORE_IDX_WIDTH-1:0]         stage_core;
+   reg                              stage_valid;
+   integer                          sel_idx; // Loop variable for the staging selection
+   integer                          core_idx; // Loop variable for the core state updates
+
+   always @(*)
+     begin
+        stage_valid = 1'b0;
+        stage_core = 'b0;
+        for (sel_idx = N_CORES - 1; sel_idx >= 0; sel_idx = sel_idx - 1)
+          if (core_state[sel_idx] == CORE_DONE)
+            begin
+               stage_valid = 1'b1;
+               stage_core = sel_idx;
+            end
+        for (sel_idx = N_CORES - 1; sel_idx >= 0; sel_idx = sel_idx - 1)
+          if (core_state[sel_idx] == CORE_FREE)
+            begin
+               stage_valid = 1'b1;
+               stage_core = sel_idx;
+            end
+        for (sel_idx = N_CORES - 1; sel_idx >= 0; sel_idx = sel_idx - 1)
+          if (core_state[sel_idx] == CORE_STAGED)
+            begin
+               stage_valid = 1'b1;
+               stage_core = sel_idx;
+            end
+
+        for (sel_idx = 0; sel_idx < N_CORES; sel_idx = sel_idx + 1)
+          done_mask[sel_idx] = (core_state[sel_idx] == CORE_DONE);
+     end
+
+   // Internal registers to hold control values written by Nios II
+   reg [ADDR_WIDTH_C-1:0]   c_addr_reg; // Register for C BRAM read address
+   reg                      clrn_reg; // Register to pulse the reset signal
+   reg [CORE_IDX_WIDTH-1:0] last_core; // Core of the most recently submitted job
+   reg [CORE_IDX_WIDTH-1:0] read_core; // Core whose C BRAM is read through address 3
+   reg [N_CORES-1:0]        irq_en_reg; // Interrupt enable mask
+
+   // Load registers (as in avalon_wrapper), plus the core they are routed to
+   reg [ADDR_BUS_A-1:0]     a_addr_reg;
+   reg [DATA_IN_WIDTH-1:0]  a_data_reg;
+   reg                      a_en_reg;
+   reg                      a_we_reg;
+   reg [ADDR_BUS_B-1:0]     b_addr_reg;
+   reg [DATA_IN_WIDTH-1:0]  b_data_reg;
+   reg                      b_en_reg;
+   reg                      b_we_reg;
+   reg [CORE_IDX_WIDTH-1:0] load_core;
+
+   // Host actions (only taken when the transfer is accepted)
+   wire host_write = chipselect && write && !waitrequest;
+   wire submit = host_write && (address == 0) && writedata[0] && writedata[1];
+   wire soft_reset = host_write && (address == 0) && !writedata[1];
+   wire load_write = host_write && (address >= 4) && (address <= 7);
+
+   // Instantiate the cores
+   genvar                   core_gen;
+   generate
+      for (core_gen = 0; core_gen < N_CORES; core_gen = core_gen + 1)
+        begin : core_gen_blk
+           top
+             #(
+               .DATA_WIDTH (DATA_WIDTH),
+               .M          (M),
+               .K          (K),
+               .N          (N),
+               .N_BANKS    (N_BANKS),
+               .PE_ROWS    (PE_ROWS),
+               .PE_COLS    (PE_COLS),
+               .PE_BIT_SERIAL (PE_BIT_SERIAL),
+               .PE_PART_ROWS (PE_PART_ROWS),
+               .PE_PART_COLS (PE_PART_COLS)
+               )
+           top_inst (
+                     .clk             (clk),
+                     .clk2x           (1'b0),  // Single-clock cores (PE_DOUBLE_PUMP off)
+                     .rst_n           (clrn_reg),
+                     .start_mult      (core_start[core_gen]),
+                     .precision       (core_precision[core_gen * PREC_WIDTH +: PREC_WIDTH]),
+                     .partition       (core_partition[core_gen]),
+                     .load_op         (2'b0),  // Strassen sequences chain seven jobs on one core;
+                     .c_targets       (8'b0),  // the dispatcher does not pin jobs, so they stay off
+                     .operand_stall   (1'b0),
+                     .slice_valid     (1'b0),
+                     .slice_slot      (0),
+                     .slice_free      (),
+                     .transpose_a     (1'b0),  // Operands used as stored
+                     .transpose_b     (1'b0),
+                     .agu_en          (1'b0),  // Default addressing
+                     .agu_a_base      (0),
+                     .agu_a_stride_r  (0),
+                     .agu_a_stride_k  (0),
+                     .agu_b_base      (0),
+                     .agu_b_stride_c  (0),
+                     .agu_b_stride_k  (0),
+                     .agu_c_base      (0),
+                     .agu_c_stride_r  (0),
+                     .agu_c_stride_c  (0),
+                     .agu_k_len       (0),
+                     .agu_m_len       (0),
+                     .agu_n_len       (0),
+                     .conv_en         (1'b0),  // GEMM jobs only
+                     .conv_in_w       (0),
+                     .conv_in_h       (0),
+                     .conv_in_c       (0),
+                     .conv_kw         (4'd0),
+                     .conv_kh         (4'd0),
+                     .conv_stride     (3'd0),
+                     .conv_pad        (3'd0),
+                     .conv_ox         (0),
+                     .conv_oy         (0),
+                     .mult_done       (core_done[core_gen]),
+
+                     // Load writes reach only the core they were staged on
+                     .en_a_brams_in   (a_en_reg && (load_core == core_gen)),
+                     .addr_a_brams_in (a_addr_reg),
+                     .we_a_brams_in   (a_we_reg && (load_core == core_gen)),
+                     .din_a_brams_in  (a_data_reg),
+
+                     .en_b_brams_in   (b_en_reg && (load_core == core_gen)),
+                     .addr_b_brams_in (b_addr_reg),
+                     .we_b_brams_in   (b_we_reg && (load_core == core_gen)),
+                     .din_b_brams_in  (b_data_reg),
+
+                     .read_en_c       (read && chipselect && (address == 8'd3) && (read_core == core_gen)),
+                     .read_addr_c     (c_addr_reg),
+                     .dout_c          (core_dout_c[core_gen * ACC_WIDTH_PE +: ACC_WIDTH_PE])
+                     );
+        end
+   endgenerate
+
+
+   // ------------------------------------------------------------------------- //
+   // Logic to handle Avalon transactions, the core states and the dispatcher   //
+   // ------------------------------------------------------------------------- //
+   always @(posedge clk or negedge reset_n)
+     begin
+        if (!reset_n)
+          begin
+             clrn_reg <= 1'b0;
+             c_addr_reg <= 'b0;
+             last_core <= 'b0;
+             read_core <= 'b0;
+             irq_en_reg <= 'b0;
+             a_addr_reg <= 'b0;
+             a_data_reg <= 'b0;
+             a_we_reg <= 'b0;
+             a_en_reg <= 'b0;
+             b_addr_reg <= 'b0;
+             b_data_reg <= 'b0;
+             b_we_reg <= 'b0;
+             b_en_reg <= 'b0;
+             load_core <= 'b0;
+             core_start <= 'b0;
+             core_precision <= 'b0;
+             core_partition <= 'b0;
+             queue_wr_ptr <= 'b0;
+             queue_rd_ptr <= 'b0;
+             queue_count <= 'b0;
+             for (core_idx = 0; core_idx < N_CORES; core_idx = core_idx + 1)
+               begin
+                  core_state[core_idx] <= CORE_FREE;
+               end
+          end
+        else
+          begin
+             // Deassert pulse signals by default
+             clrn_reg <= 1'b1;
+             a_we_reg <= 'b0;
+             a_en_reg <= 'b0;
+             b_we_reg <= 'b0;
+             b_en_reg <= 'b0;
+
+             if (soft_reset)
+               begin
+                  // Every core is reset: drop all jobs
+                  clrn_reg <= 1'b0;
+                  core_start <= 'b0;
+                  queue_wr_ptr <= 'b0;
+                  queue_rd_ptr <= 'b0;
+                  queue_count <= 'b0;
+                  for (core_idx = 0; core_idx < N_CORES; core_idx = core_idx + 1)
+                    begin
+                       core_state[core_idx] <= CORE_FREE;
+                    end
+               end
+             else
+               begin
+                  for (core_idx = 0; core_idx < N_CORES; core_idx = core_idx + 1)
+                    begin
+                       if ((load_write || submit) && stage_core == core_idx)
+                         begin
+                            // Claim the staging core; a reclaimed core drops start_mult
+                            // so that its Port A returns to the load interface
+                            core_state[core_idx] <= submit ? CORE_QUEUED : CORE_STAGED;
+                            core_start[core_idx] <= 1'b0;
+                         end
+                       else if (dispatch && head_core == core_idx)
+                         begin
+                            core_state[core_idx] <= CORE_RUNNING;
+                            core_start[core_idx] <= 1'b1;
+                            core_precision[core_idx * PREC_WIDTH +: PREC_WIDTH] <= head_precision;
+                            core_partition[core_idx] <= head_partition;
+                         end
+                       else if (core_state[core_idx] == CORE_RUNNING && core_done[core_idx])
+                         begin
+                            core_state[core_idx] <= CORE_DONE;
+                         end
+                       else if (host_write && address == 9 && writedata[core_idx] && core_state[core_idx] == CORE_DONE)
+                         begin
+                            // Result released: return the core to the idle pool
+                            core_state[core_idx] <= CORE_FREE;
+                            core_start[core_idx] <= 1'b0;
+                         end
+                    end
+
+                  // Descriptor queue
+                  if (submit)
+                    begin
+                       queue[queue_wr_ptr] <= {stage_core, writedata[PREC_WIDTH+2:2]};
+                       queue_wr_ptr <= (queue_wr_ptr == QUEUE_DEPTH - 1) ? 'b0 : queue_wr_ptr + 1;
+                       last_core <= stage_core;
+                       read_core <= stage_core;
+                    end
+                  if (dispatch)
+                    begin
+                       queue_rd_ptr <= (queue_rd_ptr == QUEUE_DEPTH - 1) ? 'b0 : queue_rd_ptr + 1;
+                    end
+                  if (submit && !dispatch)
+                    begin
+                       queue_count <= queue_count + 1;
+                    end
+                  else if (dispatch && !submit)
+                    begin
+                       queue_count <= queue_count - 1;
+                    end
+               end
+
+             if (host_write)
+               begin
+                  // Write transactions
+                  case (address)
+                    8'd2:
+                      begin // C BRAM Read Address Register
+                         c_addr_reg <= writedata[ADDR_WIDTH_C-1:0];
+                      end
+                    8'd4:
+                      begin // A BRAM Load Address Register (staging core)
+                         a_en_reg <= 1;
+                         a_addr_reg <= writedata[ADDR_BUS_A-1:0];
+                         load_core <= stage_core;
+                      end
+                    8'd5:
+                      begin // A BRAM Load Data Register (staging core)
+                         a_data_reg <= writedata[DATA_IN_WIDTH-1:0];
+                         a_we_reg <= 1;
+                         a_en_reg <= 1;
+                         load_core <= stage_core;
+                      end
+                    8'd6:
+                      begin // B BRAM Load Address Register (staging core)
+                         b_en_reg <= 1;
+                         b_addr_reg <= writedata[ADDR_BUS_B-1:0];
+                         load_core <= stage_core;
+                      end
+                    8'd7:
+                      begin // B BRAM Load Data Register (staging core)
+                         b_data_reg <= writedata[DATA_IN_WIDTH-1:0];
+                         b_we_reg <= 1;
+                         b_en_reg <= 1;
+                         load_core <= stage_core;
+                      end
+                    8'd10:
+                      begin // Read core select
+                         read_core <= writedata[CORE_IDX_WIDTH-1:0];
+                      end
+                    8'd12:
+                      begin // Interrupt enable mask
+                         irq_en_reg <= writedata[N_CORES-1:0];
+                      end
+                    default:
+                      begin
+                         // Address 0 and 9 are handled above; ignore undefined addresses
+                      end
+                  endcase
+               end // if (host_write)
+             else if (chipselect && read)
+               begin
+                  case (address)
+                    8'd1:
+                      begin
+                         readdata <= (core_state[last_core] == CORE_DONE);
+                      end
+                    8'd2:
+                      begin
+                         readdata <= c_addr_reg;
+                      end
+                    8'd3:
+                      begin
+                         readdata <= core_dout_c[read_core * ACC_WIDTH_PE +: ACC_WIDTH_PE];
+                      end
+                    8'd8:
+                      begin
+                         readdata <= {CAP_QUEUE, CAP_CORES};
+                      end
+                    8'd9:
+                      begin
+                         readdata <= done_mask;
+                      end
+                    8'd10:
+                      begin
+                         readdata <= read_core;
+                      end
+                    8'd11:
+                      begin
+                         readdata <= {stage_valid, stage_core};
+                      end
+                    8'd12:
+                      begin
+                         readdata <= irq_en_reg;
+                      end
+                    default:
+                      begin
+                         readdata <= {ACC_WIDTH_PE{1'bx}};
+                      end
+                  endcase // case (address)
+               end // if (chipselect && read)
+          end // else: !if(!reset_n)
+     end // always @ (posedge clk or negedge reset_n)
+
+   // Stall a submit while the queue is full or no core can take the job, and
+   // a load while no core is available for staging
+   assign waitrequest = chipselect && write &&
+                        ((address == 8'd0 && writedata[0] && writedata[1] && (queue_full || !stage_valid)) ||
+                         (address >= 8'd4 && address <= 8'd7 && !stage_valid));
+
+   assign irq = |(done_mask & irq_en_reg);
+
+   // Configuration check: the control register fields must fit in writedata
+   generate
+      if (CTRL_WIDTH > DATA_IN_WIDTH)
+        begin : ctrl_width_check_gen
+           initial
+             $fatal(1, "avalon_multicore_wrapper: the control register needs %0d bits, writedata (N_BANKS * DATA_WIDTH) has %0d",
+                    CTRL_WIDTH, DATA_IN_WIDTH);
+        end
+   endgenerate
+
+endmodule
@@ -9,6 +9,12 @@
 // Address 0 (Write): Control Register
 //   [0]: start_mult (pulse high to start multiplication)
 //   [1]: reset (pulse low to assert asynchronous rst_n)
+//   [PREC_WIDTH+1:2]: precision (held; B bits per element for bit-serial PEs, 0 = DATA_WIDTH)
+//   [PREC_WIDTH+2]: partition (held; run a batch of jobs on the PE regions)
+//   [PREC_WIDTH+4:PREC_WIDTH+3]: load_op (held; STRASSEN A/B load: 0/1 write, 2 add, 3 subtract)
+//   [PREC_WIDTH+12:PREC_WIDTH+5]: c_targets (held; STRASSEN C blocks the next product is written to)
+//   [PREC_WIDTH+13]: transpose_a (held; SKEW: the next job uses the transpose of the stored A)
+//   [PREC_WIDTH+14]: transpose_b (held; SKEW: the next job uses the transpose of the stored B)
 // Address 1 (Read): Status Register
 //   [0]: mult_done
 // Address 2 (Write): C BRAM Read Address
@@ -23,6 +29,11 @@
 //   [ADDR_WIDTH_B_BANK-1:0]: Address to load into B BRAMs via Port A
 // Address 7 (Write): B BRAM Load Data (Broadcast to all banks)
 //   [DATA_WIDTH-1:0]: Data to load into B BRAMs via Port A (Writing asserts en_b/we_b)
+// Addresses 8-11 (Write, AGU = 1 and ID_WIDTH >= 4): held address-generator CSRs
+//   8: A view  - [AGU_A_WIDTH-1:0] base, next field row stride, next field k stride
+//   9: B view  - [AGU_B_WIDTH-1:0] base, next field column stride, next field k stride
+//   10: C view - [AGU_C_WIDTH-1:0] base, next field row stride, next field column stride
+//   11: Bounds - [0] agu_en, then k_len ($clog2(K)+1 bits), m_len, n_len (0 = full size)
 //
 // Assumptions:
 // - Assumes DATA_WIDTH, M, K, N, N_BANKS, PE_ROWS, PE_COLS are parameters
@@ -41,7 +52,13 @@ module avalon_wrapper
     parameter N_BANKS = 3,
     parameter PE_ROWS = M,
     parameter PE_COLS = N,
-    // ID_WIDTH needs to be wide enough for all defined addresses (0-7 -> 8 addresses -> 3 bits)
+    parameter PE_BIT_SERIAL = 0, // 1: bit-serial PEs, job precision from the control register
+    parameter PE_PART_ROWS = 1,  // PE regions for partitioned jobs (control register partition bit)
+    parameter PE_PART_COLS = 1,
+    parameter STRASSEN = 0,      // 1: Strassen block mode (load_op/c_targets fields, four C blocks)
+    parameter SKEW = 0,          // 1: skewed A/B storage (transpose_a/b fields)
+    parameter AGU = 0, // 1: programmable address generators, CSRs at addresses 8-11
+    // ID_WIDTH needs to be wide enough for all defined addresses (0-7 -> 8 addresses -> 3 bits; 4 with AGU)
     parameter ID_WIDTH = 3
     )
    (
@@ -62,27 +79,45 @@ module avalon_wrapper
    // Derived Parameters (matching top module/datapath/controller)
    // Hardcoded address widths to avoid $clog2 synthesis issues if necessary
    localparam DATA_IN_WIDTH = N_BANKS * DATA_WIDTH;
-   localparam ADDR_WIDTH_A = $clog2(N_BANKS) + (M/N_BANKS * K > 0) ? $clog2(M/N_BANKS * K) : 1;
-   localparam ADDR_WIDTH_B = $clog2(N_BANKS) + (K * N/N_BANKS > 0) ? $clog2(K * N/N_BANKS) : 1;
-   localparam ADDR_WIDTH_C = (M * N > 0) ? $clog2(M * N) : 1;
+   localparam ADDR_WIDTH_A = $clog2(N_BANKS) + ((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K) : 1;
+   localparam ADDR_WIDTH_B = $clog2(N_BANKS) + (K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1;
+   localparam ADDR_WIDTH_C = (M * N > 0) ? $clog2(M * N * (STRASSEN ? 4 : 1)) : 1;
    localparam ACC_WIDTH_PE = DATA_WIDTH * 2 + ((K > 1) ? $clog2(K) : 1); // PE accumulator width must match
    localparam N_PE = PE_ROWS * PE_COLS; // Total number of PEs
+   localparam PREC_WIDTH = $clog2(DATA_WIDTH+1); // Width of the precision field
+   localparam CTRL_WIDTH = PREC_WIDTH + 15; // Control register bits in use (see register map)
+   localparam AGU_A_WIDTH = ((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K) : 1; // A in-bank address
+   localparam AGU_B_WIDTH = (K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1; // B in-bank address
+   localparam AGU_C_WIDTH = ADDR_WIDTH_C; // C address
+   localparam AGU_K_WIDTH = $clog2(K) + 1; // K length field
+   localparam AGU_M_WIDTH = $clog2(M+1); // Row bound field
+   localparam AGU_N_WIDTH = $clog2(N+1); // Column bound field
 
 
    // Internal registers to hold control values written by Nios II
    reg [ADDR_WIDTH_C-1:0] c_addr_reg; // Register for C BRAM read address
    reg                    start_mult_reg;
    reg                    clrn_reg; // Register to pulse the reset signal
+   reg [PREC_WIDTH-1:0]   precision_reg; // Register holding the job precision
+   reg                    partition_reg; // Register holding the partitioned-mode flag
+   reg [1:0]              load_op_reg; // Register holding the A/B load operation
+   reg [7:0]              c_targets_reg; // Register holding the C block targets
+   reg                    transpose_a_reg; // Register holding the A transpose flag
+   reg                    transpose_b_reg; // Register holding the B transpose flag
+   reg [3*AGU_A_WIDTH-1:0] agu_a_reg; // AGU: A {k stride, row stride, base}
+   reg [3*AGU_B_WIDTH-1:0] agu_b_reg; // AGU: B {k stride, column stride, base}
+   reg [3*AGU_C_WIDTH-1:0] agu_c_reg; // AGU: C {column stride, row stride, base}
+   reg [AGU_N_WIDTH+AGU_M_WIDTH+AGU_K_WIDTH:0] agu_bounds_reg; // AGU: {n_len, m_len, k_len, agu_en}
 
    // Internal registers for A and B BRAM loading via Nios II (connected to top-level Port A inputs)
    // These registers capture the address and data written by Nios II.
-   reg [N_BANKS * ($clog2(N_BANKS) + ((M/N_BANKS * K > 0) ? $clog2(M/N_BANKS * K) : 1)) - 1:0] a_addr_reg; // Address for A banks (broadcast)
+   reg [N_BANKS * ($clog2(N_BANKS) + (((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K) : 1)) - 1:0] a_addr_reg; // Address for A banks (broadcast)
    reg [DATA_IN_WIDTH-1:0]                                                                     a_data_reg; // Data for A banks (broadcast)
    reg                                                                                         a_en_reg; // Enable/Write Enable pulse for A banks
    reg                                                                                         a_we_reg;
 
 
-   reg [N_BANKS * ($clog2(N_BANKS) + ((K * N/N_BANKS > 0) ? $clog2(K * N/N_BANKS) : 1)) - 1:0] b_addr_reg; // Address for A banks (broadcast)
+   reg [N_BANKS * ($clog2(N_BANKS) + ((K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1)) - 1:0] b_addr_reg; // Address for A banks (broadcast)
    reg [DATA_IN_WIDTH-1:0]                                                                     b_data_reg; // Data for A banks (broadcast)
    reg                                                                                         b_en_reg; // Enable/Write Enable pulse for A banks
    reg                                                                                         b_we_reg;
@@ -101,14 +136,54 @@ module avalon_wrapper
        .N          (N),
        .N_BANKS    (N_BANKS),
        .PE_ROWS    (PE_ROWS),
-       .PE_COLS    (PE_COLS)
+       .PE_COLS    (PE_COLS),
+       .PE_BIT_SERIAL (PE_BIT_SERIAL),
+       .PE_PART_ROWS (PE_PART_ROWS),
+       .PE_PART_COLS (PE_PART_COLS),
+       .STRASSEN   (STRASSEN),
+       .SKEW       (SKEW),
+       .AGU        (AGU)
        )
    top_inst (
              .clk                                (clk),
+             .clk2x                              (1'b0), // Single-clock core (PE_DOUBLE_PUMP off)
              .rst_n                              (clrn_reg), // Connect Avalon reset to top-level reset
 
              // External Control Input           (from Avalon)
              .start_mult                         (start_mult_reg), // Connect to internal start_mult register
+             .precision                          (precision_reg), // Connect to internal precision register
+             .partition                          (partition_reg), // Connect to internal partition register
+             .load_op                            (load_op_reg), // Connect to internal load operation register
+             .c_targets                          (c_targets_reg), // Connect to internal C targets register
+             .operand_stall                      (1'b0), // BRAM operands never underflow
+             .slice_valid                        (1'b0), // A/B fully resident before start
+             .slice_slot                         (0),
+             .slice_free                         (),
+             .transpose_a                        (transpose_a_reg), // Connect to internal transpose flags
+             .transpose_b                        (transpose_b_reg),
+             .agu_en                             (agu_bounds_reg[0]), // Address-generator CSRs (AGU)
+             .agu_a_base                         (agu_a_reg[AGU_A_WIDTH-1:0]),
+             .agu_a_stride_r                     (agu_a_reg[2*AGU_A_WIDTH-1:AGU_A_WIDTH]),
+             .agu_a_stride_k                     (agu_a_reg[3*AGU_A_WIDTH-1:2*AGU_A_WIDTH]),
+             .agu_b_base                         (agu_b_reg[AGU_B_WIDTH-1:0]),
+             .agu_b_stride_c                     (agu_b_reg[2*AGU_B_WIDTH-1:AGU_B_WIDTH]),
+             .agu_b_stride_k                     (agu_b_reg[3*AGU_B_WIDTH-1:2*AGU_B_WIDTH]),
+             .agu_c_base                         (agu_c_reg[AGU_C_WIDTH-1:0]),
+             .agu_c_stride_r                     (agu_c_reg[2*AGU_C_WIDTH-1:AGU_C_WIDTH]),
+             .agu_c_stride_c                     (agu_c_reg[3*AGU_C_WIDTH-1:2*AGU_C_WIDTH]),
+             .agu_k_len                          (agu_bounds_reg[AGU_K_WIDTH:1]),
+             .agu_m_len                          (agu_bounds_reg[AGU_M_WIDTH+AGU_K_WIDTH:AGU_K_WIDTH+1]),
+             .agu_n_len                          (agu_bounds_reg[AGU_N_WIDTH+AGU_M_WIDTH+AGU_K_WIDTH:AGU_M_WIDTH+AGU_K_WIDTH+1]),
+             .conv_en                            (1'b0), // GEMM jobs only (CONV off)
+             .conv_in_w                          (0),
+             .conv_in_h                          (0),
+             .conv_in_c                          (0),
+             .conv_kw                            (4'd0),
+             .conv_kh                            (4'd0),
+             .conv_stride                        (3'd0),
+             .conv_pad                           (3'd0),
+             .conv_ox                            (0),
+             .conv_oy                            (0),
 
              // External Status Output           (to Avalon)
              .mult_done                          (top_mult_done), // Connect to internal wire
@@ -143,6 +218,16 @@ module avalon_wrapper
           begin
              start_mult_reg <= 1'b0;
              clrn_reg <= 1'b0; // Deassert reset pulse
+             precision_reg <= 'b0; // Full precision
+             partition_reg <= 1'b0; // Whole-array jobs
+             load_op_reg <= 2'b0; // Plain loads
+             c_targets_reg <= 8'b0; // Single C block
+             transpose_a_reg <= 1'b0; // Operands used as stored
+             transpose_b_reg <= 1'b0;
+             agu_a_reg <= 'b0;
+             agu_b_reg <= 'b0;
+             agu_c_reg <= 'b0;
+             agu_bounds_reg <= 'b0; // Default addressing
              c_addr_reg <= 'b0;
              a_addr_reg <= 'b0;
              a_data_reg <= 'b0;
@@ -172,6 +257,12 @@ module avalon_wrapper
                       begin // Control Register
                          start_mult_reg <= writedata[0]; // Assuming start_mult is bit 0 (pulse)
                          clrn_reg <= writedata[1]; // Assuming reset pulse is bit 1 (pulse)
+                         precision_reg <= writedata[PREC_WIDTH+1:2]; // Precision for the next job (held)
+                         partition_reg <= writedata[PREC_WIDTH+2]; // Partitioned mode for the next job (held)
+                         load_op_reg <= writedata[PREC_WIDTH+4:PREC_WIDTH+3]; // Operation of the following loads (held)
+                         c_targets_reg <= writedata[PREC_WIDTH+12:PREC_WIDTH+5]; // C blocks of the next job (held)
+                         transpose_a_reg <= writedata[PREC_WIDTH+13]; // Operand orientation of the next job (held)
+                         transpose_b_reg <= writedata[PREC_WIDTH+14];
                       end
                     8'd2:
                       begin // C BRAM Read Address Register (Nios II writes the address it wants to read from C)
@@ -180,7 +271,7 @@ module avalon_wrapper
                     8'd4:
                       begin // A BRAM Load Address Register (Nios II writes the address for A BRAM via Port A)
                          a_en_reg <= 1;
-                         a_addr_reg <= writedata[N_BANKS * ($clog2(N_BANKS) + ((M/N_BANKS * K > 0) ? $clog2(M/N_BANKS * K) : 1)) - 1:0]; // Capture the address
+                         a_addr_reg <= writedata[N_BANKS * ($clog2(N_BANKS) + (((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K) : 1)) - 1:0]; // Capture the address
                       end
                     8'd5:
                       begin // A BRAM Load Data Register (Nios II writes the data for A BRAM via Port A)
@@ -191,7 +282,7 @@ module avalon_wrapper
                     8'd6:
                       begin // B BRAM Load Address Register (Nios II writes the address for B BRAM via Port A)
                          b_en_reg <= 1;
-                         b_addr_reg <= writedata[N_BANKS * ($clog2(N_BANKS) + ((K * N/N_BANKS > 0) ? $clog2(K * N/N_BANKS) : 1)) - 1:0]; // Capture the address
+                         b_addr_reg <= writedata[N_BANKS * ($clog2(N_BANKS) + ((K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1)) - 1:0]; // Capture the address
                       end
                     8'd7:
                       begin // B BRAM Load Data Register (Nios II writes the data for B BRAM via Port A)
@@ -199,6 +290,22 @@ module avalon_wrapper
                          b_we_reg <= 1; // Pulse high to trigger B BRAM write via Port A for all banks
                          b_en_reg <= 1; // Pulse high to trigger B BRAM write via Port A for all banks
                       end
+                    8'd8:
+                      begin // AGU A view (held for the following jobs)
+                         agu_a_reg <= writedata[3*AGU_A_WIDTH-1:0];
+                      end
+                    8'd9:
+                      begin // AGU B view (held)
+                         agu_b_reg <= writedata[3*AGU_B_WIDTH-1:0];
+                      end
+                    8'd10:
+                      begin // AGU C view (held)
+                         agu_c_reg <= writedata[3*AGU_C_WIDTH-1:0];
+                      end
+                    8'd11:
+                      begin // AGU enable and loop bounds (held)
+                         agu_bounds_reg <= writedata[AGU_N_WIDTH+AGU_M_WIDTH+AGU_K_WIDTH:0];
+                      end
                     default:
                       begin
                          // Ignore writes to undefined addresses
@@ -241,5 +348,14 @@ module avalon_wrapper
                         ((start_mult_reg || !top_mult_done) || // Busy during execution
                          (write && (address == 8'd5 || address == 8'd7))); // Busy during load data write
 
+   // Configuration check: the control register fields must fit in writedata
+   generate
+      if (CTRL_WIDTH > DATA_IN_WIDTH)
+        begin : ctrl_width_check_gen
+           initial
+             $fatal(1, "avalon_wrapper: the control register needs %0d bits, writedata (N_BANKS * DATA_WIDTH) has %0d",
+                    CTRL_WIDTH, DATA_IN_WIDTH);
+        end
+   endgenerate
 
 endmodule
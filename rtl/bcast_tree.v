@@ -0,0 +1,124 @@
+//----------------------------------------------------------------------------
+// Module: bcast_tree
+// Description: Pipelined broadcast (fan-out) register tree.
+//              Distributes one signal to N_OUT destinations through DEPTH
+//              register levels. Each register drives at most FANOUT loads,
+//              so the per-stage net fan-out stays small however large the
+//              PE array grows. Every output has exactly DEPTH cycles of
+//              latency, so trees with the same DEPTH stay aligned.
+//
+// Structure:
+// - Level l (1..DEPTH) holds ceil(N_OUT / FANOUT^(DEPTH-l+1)) registers.
+// - Register i of level l is fed by register i/FANOUT of level l-1
+//   (level 1 is fed by the input d).
+// - Output j is driven by register j/FANOUT of the last level.
+// - DEPTH = 0 degenerates to plain wires (no added latency).
+// - RESET = 0 builds the registers without clr_n (for pure data signals).
+//----------------------------------------------------------------------------
+module bcast_tree
+#(
+  parameter WIDTH = 1,  // Width of the broadcast signal
+  parameter N_OUT = 4,  // Number of destinations
+  parameter FANOUT = 4, // Loads driven by each tree register
+  parameter DEPTH = 1,  // Register levels (0 = no pipelining)
+  parameter RESET = 1   // 1: registers cleared by clr_n, 0: reset-less
+)
+(
+ input                    clk,
+ input                    clr_n, // Asynchronous active-low reset
+ input                    ce,    // Clock enable: low holds every tree register
+ input [WIDTH-1:0]        d,     // Signal to broadcast
+ output [N_OUT*WIDTH-1:0] q      // N_OUT copies of d, delayed by DEPTH cycles
+);
+
+   // Number of registers in tree level 'level' (1..DEPTH)
+   function integer level_nodes;
+      input integer level;
+      integer       span, l;
+      begin
+         span = FANOUT;
+         for (l = level; l < DEPTH; l = l + 1)
+           begin
+              span = span * FANOUT;
+           end
+         level_nodes = (N_OUT + span - 1) / span;
+      end
+   endfunction
+
+   // Index of the first register of tree level 'level' in the flattened tree
+   function integer level_base;
+      input integer level;
+      integer       l;
+      begin
+         level_base = 0;
+         for (l = 1; l < level; l = l + 1)
+           begin
+              level_base = level_base + level_nodes(l);
+           end
+      end
+   endfunction
+
+   genvar                 l_gen, i_gen, j_gen;
+   generate
+      if (DEPTH == 0)
+        begin : bcast_wire_gen
+           for (j_gen = 0; j_gen < N_OUT; j_gen = j_gen + 1)
+             begin : out_gen
+                assign q[j_gen * WIDTH +: WIDTH] = d;
+             end
+        end
+      else
+        begin : bcast_reg_gen
+           // Flattened tree registers. Synthesis must not merge the duplicates.
+           (* preserve, keep = "true" *) reg [level_base(DEPTH + 1) * WIDTH - 1:0] tree_q;
+
+           for (l_gen = 1; l_gen <= DEPTH; l_gen = l_gen + 1)
+             begin : level_gen
+                for (i_gen = 0; i_gen < level_nodes(l_gen); i_gen = i_gen + 1)
+                  begin : node_gen
+                     wire [WIDTH-1:0] node_d; // Parent register (or d for level 1)
+
+                     if (l_gen == 1)
+                       begin : root_gen
+                          assign node_d = d;
+                       end
+                     else
+                       begin : child_gen
+                          assign node_d = tree_q[(level_base(l_gen - 1) + i_gen / FANOUT) * WIDTH +: WIDTH];
+                       end
+
+                     if (RESET)
+                       begin : node_rst_gen
+                          always @(posedge clk or negedge clr_n)
+                            begin
+                               if (!clr_n)
+                                 begin
+                                    tree_q[(level_base(l_gen) + i_gen) * WIDTH +: WIDTH] <= {WIDTH{1'b0}};
+                                 end
+                               else if (ce)
+                                 begin
+                                    tree_q[(level_base(l_gen) + i_gen) * WIDTH +: WIDTH] <= node_d;
+                                 end
+                            end
+                       end
+                     else
+                       begin : node_gen
+                          always @(posedge clk)
+                            begin
+                               if (ce)
+                                 begin
+                                    tree_q[(level_base(l_gen) + i_gen) * WIDTH +: WIDTH] <= node_d;
+                                 end
+                            end
+                       end
+                  end
+             end
+
+           for (j_gen = 0; j_gen < N_OUT; j_gen = j_gen + 1)
+             begin : out_gen
+                assign q[j_gen * WIDTH +: WIDTH] = tree_q[(level_base(DEPTH) + j_gen / FANOUT) * WIDTH +: WIDTH];
+             end
+        end
+   endgenerate
+
+endmodule // bcast_tree
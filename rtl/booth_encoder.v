@@ -0,0 +1,40 @@
+//----------------------------------------------------------------------------
+// Module: booth_encoder
+// Description: Radix-4 (modified) Booth recoder for an unsigned N-bit operand.
+//              Produces N/2+1 signed digits in {-2, -1, 0, +1, +2} such that
+//              a = sum(digit[i] * 4^i). Each digit is encoded as {neg, two, one}:
+//              - one: |digit| == 1
+//              - two: |digit| == 2
+//              - neg: digit < 0 (never set for a zero digit)
+//              The encoding is consumed by booth_multiplier. In the datapath it
+//              runs once per PE row and the digits are broadcast along the row.
+//----------------------------------------------------------------------------
+module booth_encoder
+#(
+  parameter N = 16 // Operand width
+)
+(
+ input wire [N-1:0]            a,     // Unsigned operand
+ output wire [3*(N/2+1)-1:0]   digits // Booth digits, digit i at [3*i +: 3] = {neg, two, one}
+);
+
+   localparam N_DIGITS = N/2 + 1; // Enough digits to cover the zero-extended operand
+
+   // Operand with the implicit y[-1] = 0 below the LSB and zero extension above the MSB
+   wire [2*N_DIGITS:0] a_ext = {{(2*N_DIGITS - N){1'b0}}, a, 1'b0};
+
+   generate
+      genvar i;
+      for (i = 0; i < N_DIGITS; i = i + 1)
+        begin : gen_digits
+           wire y_hi  = a_ext[2*i + 2]; // y[2i+1]
+           wire y_mid = a_ext[2*i + 1]; // y[2i]
+           wire y_lo  = a_ext[2*i];     // y[2i-1]
+
+           assign digits[3*i + 0] = y_mid ^ y_lo;                                          // one
+           assign digits[3*i + 1] = (y_hi & ~y_mid & ~y_lo) | (~y_hi & y_mid & y_lo);     // two
+           assign digits[3*i + 2] = y_hi & ~(y_mid & y_lo);                                // neg
+        end
+   endgenerate
+
+endmodule // booth_encoder
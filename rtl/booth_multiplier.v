@@ -0,0 +1,119 @@
+//----------------------------------------------------------------------------
+// Module: booth_multiplier
+// Description: Radix-4 Booth multiplier working on pre-recoded digits.
+//              The multiplier operand arrives already recoded by booth_encoder,
+//              so this module holds only the partial-product selection and the
+//              reduction: N/2+1 partial products instead of the N rows of
+//              multiplier_carrysave.
+//
+//              Partial product i is digit[i] * b, sign-extended to 2N bits and
+//              weighted by 4^i. Negative digits use the one's complement of the
+//              magnitude plus a correction bit at position 2i; all correction
+//              bits share one extra vector. The vectors are reduced with a chain
+//              of carry_save_adder stages to a sum/carry pair.
+//
+//              Port-compatible with multiplier_carrysave's outputs:
+//              p = a*b (modulo 2^2N) and ps + pc == p (carry-save form).
+//              The sign-extended vectors only sum to the product modulo the
+//              reduction width, so ps/pc are OUT_WIDTH bits wide: a consumer
+//              that adds them at more than 2N bits (a carry-save accumulator)
+//              sets OUT_WIDTH to its own width.
+//----------------------------------------------------------------------------
+module booth_multiplier
+#(
+  parameter N = 16,          // Data width parameter
+  parameter FINAL_ADDER = 0, // Final adder: 0 = inferred adder, 1/2/3 = prefix_adder ARCH
+  parameter OUT_WIDTH = 2*N  // Reduction width: ps + pc == a*b (modulo 2^OUT_WIDTH), >= 2N
+)
+(
+ input wire [3*(N/2+1)-1:0]  digits, // Booth digits of the multiplier (from booth_encoder)
+ input wire [N-1:0]          b,      // Multiplicand
+ output wire [N*2-1:0]       p,      // Product
+ output wire [OUT_WIDTH-1:0] ps,     // Product in carry-save form: sum vector
+ output wire [OUT_WIDTH-1:0] pc      // Product in carry-save form: carry vector (ps + pc == a*b)
+);
+
+   localparam N_DIGITS = N/2 + 1;
+   localparam N_VECS = N_DIGITS + 1; // Partial products plus the correction vector
+
+   // Partial-product vectors (flattened), vector N_DIGITS holds the correction bits
+   wire [N_VECS*OUT_WIDTH-1:0] pp;
+   wire [OUT_WIDTH-1:0]        corr;
+
+   generate
+      genvar i;
+      for (i = 0; i < N_DIGITS; i = i + 1)
+        begin : gen_pp
+           wire one = digits[3*i + 0];
+           wire two = digits[3*i + 1];
+           wire neg = digits[3*i + 2];
+
+           // Magnitude selection: 0, b or 2b (N+1 bits)
+           wire [N:0] mag = ({(N+1){one}} & {1'b0, b}) | ({(N+1){two}} & {b, 1'b0});
+
+           // One's complement for negative digits, then sign extension to OUT_WIDTH bits
+           wire [N:0]           pp_raw = mag ^ {(N+1){neg}};
+           wire [OUT_WIDTH-1:0] pp_ext = {{(OUT_WIDTH-N-1){neg}}, pp_raw};
+
+           assign pp[i*OUT_WIDTH +: OUT_WIDTH] = pp_ext << (2*i);
+           assign corr[2*i] = neg; // +1 completes the two's complement
+           if (2*i + 1 < OUT_WIDTH)
+             begin : gen_corr_gap
+                assign corr[2*i + 1] = 1'b0;
+             end
+        end
+
+      // Correction bits above the last digit position
+      for (i = 2*N_DIGITS; i < OUT_WIDTH; i = i + 1)
+        begin : gen_corr_top
+           assign corr[i] = 1'b0;
+        end
+   endgenerate
+
+   assign pp[N_DIGITS*OUT_WIDTH +: OUT_WIDTH] = corr;
+
+   // Carry-save reduction chain: (pp0, pp1, pp2) -> (s, c), then fold in one vector per stage
+   wire [(N_VECS-1)*OUT_WIDTH-1:0] red_sum;
+   wire [(N_VECS-1)*OUT_WIDTH-1:0] red_carry;
+
+   generate
+      genvar r;
+      for (r = 1; r < N_VECS - 1; r = r + 1)
+        begin : gen_reduce
+           if (r == 1)
+             begin : gen_first
+                carry_save_adder #(.WIDTH(OUT_WIDTH)) csa(.x     (pp[0 +: OUT_WIDTH]),
+                                                          .y     (pp[OUT_WIDTH +: OUT_WIDTH]),
+                                                          .z     (pp[2*OUT_WIDTH +: OUT_WIDTH]),
+                                                          .sum   (red_sum[r*OUT_WIDTH +: OUT_WIDTH]),
+                                                          .carry (red_carry[r*OUT_WIDTH +: OUT_WIDTH]));
+             end
+           else
+             begin : gen_next
+                carry_save_adder #(.WIDTH(OUT_WIDTH)) csa(.x     (red_sum[(r-1)*OUT_WIDTH +: OUT_WIDTH]),
+                                                          .y     (red_carry[(r-1)*OUT_WIDTH +: OUT_WIDTH]),
+                                                          .z     (pp[(r+1)*OUT_WIDTH +: OUT_WIDTH]),
+                                                          .sum   (red_sum[r*OUT_WIDTH +: OUT_WIDTH]),
+                                                          .carry (red_carry[r*OUT_WIDTH +: OUT_WIDTH]));
+             end
+        end
+   endgenerate
+
+   assign ps = red_sum[(N_VECS-2)*OUT_WIDTH +: OUT_WIDTH];
+   assign pc = red_carry[(N_VECS-2)*OUT_WIDTH +: OUT_WIDTH];
+
+   // Final carry-propagate adder (the low 2N bits of ps + pc are the product)
+   generate
+      if (FINAL_ADDER != 0)
+        begin : gen_prefix_final
+           prefix_adder #(.WIDTH(2*N), .ARCH(FINAL_ADDER)) final_adder(.a   (ps[2*N-1:0]),
+                                                                       .b   (pc[2*N-1:0]),
+                                                                       .sum (p));
+        end
+      else
+        begin : gen_inferred_final
+           assign p = ps[2*N-1:0] + pc[2*N-1:0];
+        end
+   endgenerate
+
+endmodule // booth_multiplier
@@ -1,24 +1,32 @@
 module bram
 #(
     parameter ADDR_WIDTH = 10,
-    parameter DATA_WIDTH = 32
+    parameter DATA_WIDTH = 32,
+    parameter OUT_REG = 0,      // 1: extra output pipeline register (read latency 2 instead of 1)
+    parameter B_RATIO = 1       // Port B words per access (power of 2): Port B is B_RATIO times as
+                                // wide, word w of access addr_b is word addr_b * B_RATIO + w of Port A
 )(
     input                       clk,    // Common clock for both ports
     input                       en_a,   // Port A enable
     input                       we_a,   // Port A write enable
     input [ADDR_WIDTH-1:0]      addr_a, // Port A address
     input [DATA_WIDTH-1:0]      din_a,  // Port A data in
-    output reg [DATA_WIDTH-1:0] dout_a, // Port A data out
+    output [DATA_WIDTH-1:0]     dout_a, // Port A data out
 
     input                       en_b,   // Port B enable
     input                       we_b,   // Port B write enable
-    input [ADDR_WIDTH-1:0]      addr_b, // Port B address
-    input [DATA_WIDTH-1:0]      din_b,  // Port B data in
-    output reg [DATA_WIDTH-1:0] dout_b  // Port B data out
+    input [ADDR_WIDTH-$clog2(B_RATIO)-1:0] addr_b, // Port B address (in B_RATIO-word units)
+    input [DATA_WIDTH*B_RATIO-1:0]         din_b,  // Port B data in (word 0 in the low bits)
+    output [DATA_WIDTH*B_RATIO-1:0]        dout_b  // Port B data out
 );
 
    (* ram_style = "block" *) reg [DATA_WIDTH-1:0] mem [(1<<ADDR_WIDTH)-1:0];
 
+   reg [DATA_WIDTH-1:0] ram_dout_a; // Port A array read register
+   reg [DATA_WIDTH*B_RATIO-1:0] ram_dout_b; // Port B array read register
+
+   integer lane; // Port B word within the access
+
    // Port A operation
    always @(posedge clk) begin
       if (en_a) begin
@@ -27,24 +35,47 @@ module bram
             // In NO CHANGE mode, output doesn't change on write
         end
         else begin
-            dout_a <= mem[addr_a]; // Read operation
+            ram_dout_a <= mem[addr_a]; // Read operation
         end
     end
     // When disabled, output retains its value (NO CHANGE mode)
 end
 
-// Port B operation
+// Port B operation (B_RATIO words per access, one per lane)
 always @(posedge clk) begin
    if (en_b) begin
+      for (lane = 0; lane < B_RATIO; lane = lane + 1) begin
         if (we_b) begin
-            mem[addr_b] <= din_b;
+            mem[addr_b * B_RATIO + lane] <= din_b[lane * DATA_WIDTH +: DATA_WIDTH];
             // In NO CHANGE mode, output doesn't change on write
         end
         else begin
-            dout_b <= mem[addr_b]; // Read operation
+            ram_dout_b[lane * DATA_WIDTH +: DATA_WIDTH] <= mem[addr_b * B_RATIO + lane]; // Read operation
         end
+      end
     end
     // When disabled, output retains its value (NO CHANGE mode)
 end
 
+// Optional output register (maps onto the block RAM's own output register).
+// It loads every cycle, so a held read result also holds at the output.
+generate
+   if (OUT_REG) begin : out_reg_gen
+      reg [DATA_WIDTH-1:0] dout_a_reg;
+      reg [DATA_WIDTH*B_RATIO-1:0] dout_b_reg;
+
+      always @(posedge clk) begin
+         dout_a_reg <= ram_dout_a;
+         dout_b_reg <= ram_dout_b;
+      end
+
+      assign dout_a = dout_a_reg;
+      assign dout_b = dout_b_reg;
+   end
+   else begin : out_direct_gen
+      assign dout_a = ram_dout_a;
+      assign dout_b = ram_dout_b;
+   end
+endgenerate
+
 endmodule
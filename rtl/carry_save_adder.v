@@ -0,0 +1,36 @@
+//----------------------------------------------------------------------------
+// Module: carry_save_adder
+// Description: WIDTH-bit 3:2 carry-save adder built from full_adder cells.
+//              x + y + z == sum + carry (modulo 2^WIDTH). No carry ripples
+//              between bit positions; the carry vector is pre-shifted left.
+//----------------------------------------------------------------------------
+module carry_save_adder
+#(
+  parameter WIDTH = 32 // Operand width
+)
+(
+ input wire [WIDTH-1:0]  x,     // First operand
+ input wire [WIDTH-1:0]  y,     // Second operand
+ input wire [WIDTH-1:0]  z,     // Third operand
+ output wire [WIDTH-1:0] sum,   // Bitwise sum
+ output wire [WIDTH-1:0] carry  // Carries, already weighted (shifted left by one)
+);
+
+   wire [WIDTH-1:0] c_out; // Carry out of each bit position
+
+   generate
+      genvar i;
+      for (i = 0; i < WIDTH; i = i + 1)
+        begin : gen_bits
+           full_adder fa(.a    (x[i]),
+                         .b    (y[i]),
+                         .c_in (z[i]),
+                         .sum  (sum[i]),
+                         .c_out(c_out[i]));
+        end
+   endgenerate
+
+   // Carry out of bit i has weight 2^(i+1); the carry out of the MSB is dropped
+   assign carry = {c_out[WIDTH-2:0], 1'b0};
+
+endmodule // carry_save_adder
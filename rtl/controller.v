@@ -9,36 +9,160 @@ module controller
 
     // Parameters for the 2D PE Array dimensions (Must match datapath)
     parameter PE_ROWS = M,     // Number of PE rows = M
-    parameter PE_COLS = N      // Number of PE columns = N
+    parameter PE_COLS = N,     // Number of PE columns = N
+
+    // PE pipeline depth from input registration to output_valid (Must match datapath PEs)
+    parameter PE_PIPE_DEPTH = 3,
+
+    // Register levels of the datapath's control/operand distribution trees (Must match datapath)
+    parameter BCAST_DEPTH = 0,
+
+    // A/B BRAM read latency in cycles from address to dout (Must match datapath, >= 1)
+    parameter BRAM_RD_LATENCY = 1,
+
+    // 1: datapath small-matrix mode (register-file operands, results read from the
+    //    PEs). The schedule is IDLE -> ACCUMULATE -> WAIT_PE_DONE -> DONE, skipping
+    //    the buffer reset, the BRAM prefetch and the C BRAM writeback (Must match datapath)
+    parameter SMALL_MATRIX = 0,
+
+    // K-split factor (1 or 2): ACCUMULATE runs ceil(K/K_SPLIT) steps and the
+    // datapath adds one partial-sum stage (Must match datapath)
+    parameter K_SPLIT = 1,
+
+    // 1: matrix-vector mode, PEs are independent dot-product lanes and only
+    //    min(M, PE_ROWS*PE_COLS) results are written back (Must match datapath).
+    //    Lane l reads A bank l, so M <= N_BANKS lanes are busy at most
+    parameter GEMV = 0,
+
+    // 1: bit-serial PEs. ACCUMULATE runs one pass over K per bit plane of B,
+    //    MSB plane first, for 'precision' planes (Must match datapath)
+    parameter BIT_SERIAL = 0,
+
+    // 1: Strassen/Winograd block mode. C holds four M x N blocks and the
+    //    writeback runs once per block selected in 'c_targets', each pass
+    //    overwriting, adding to or subtracting from the block (Must match datapath)
+    parameter STRASSEN = 0,
+
+    // 1: 'k_stall' pauses the K loop. k_stall high in a cycle makes the next
+    //    ACCUMULATE cycle a bubble: no PE step, no BRAM read (the BRAM outputs hold
+    //    the pending operands), k held. Needs BRAM_RD_LATENCY = 1.
+    parameter K_STALL = 0,
+
+    // Streaming K: > 0 = number of k-slice slots resident in the A/B banks. Slice
+    //    k lives at bank address k % STREAM_K_SLOTS and is only read once the
+    //    loader has marked its slot valid ('slice_valid'); reading it frees the
+    //    slot for slice k + STREAM_K_SLOTS. Uses the K_STALL bubbles (BRAM_RD_LATENCY = 1).
+    //    0 = A/B fully resident before start_mult
+    parameter STREAM_K_SLOTS = 0,
+
+    // 1: convolution (im2col) addressing, per job when conv_en is high. The A banks
+    //    hold one input feature map (IFM) per PE row, C x H x W at address
+    //    (c*H + y)*W + x, and the job computes the M output pixels (oy, ox..ox+M-1)
+    //    of the N filters in B (K = C*kh*kw steps, k = (c*kh + ky)*kw + kx). PE row
+    //    r reads IFM pixel (oy*S + ky - P, (ox+r)*S + kx - P); reads in the
+    //    padding ring (and steps past C*kh*kw) are zeroed by the datapath. Needs M <= N_BANKS and the plain
+    //    K schedule (no SMALL_MATRIX, K_SPLIT, BIT_SERIAL, STREAM_K_SLOTS).
+    parameter CONV = 0,
+    parameter CONV_DIM_WIDTH = 8,  // Width of the IFM width/height and output position fields
+    parameter CONV_IFM_DEPTH = 0,  // A bank words added for the IFM (>= C*H*W - ceil(M/N_BANKS)*K)
+
+    // 1: programmable address generation, per job when agu_en is high. Step k of
+    //    PE row r reads A bank r at agu_a_base + r*agu_a_stride_r + k*agu_a_stride_k,
+    //    PE column c reads B bank c at agu_b_base + c*agu_b_stride_c + k*agu_b_stride_k,
+    //    and C[i][j] is written to agu_c_base + i*agu_c_stride_r + j*agu_c_stride_c
+    //    (all modulo the bank/BRAM depth). The job runs agu_k_len K steps and only
+    //    writes the agu_m_len x agu_n_len corner of C. Needs the plain GEMM schedule
+    //    (no SMALL_MATRIX, K_SPLIT, GEMV, BIT_SERIAL, STREAM_K_SLOTS, CONV jobs)
+    parameter AGU = 0,
+
+    // 1: skewed (diagonal) A/B storage. A stored matrix S (R x C) holds S[r][c] in
+    //    bank (r + c) % N_BANKS at address (r / N_BANKS) * C + c, so that both a
+    //    row and a column of S can be read in one cycle. Per job, transpose_a
+    //    selects A = S^T instead of A = S (and likewise transpose_b for B), at the
+    //    same cost. Step k of PE row/column p reads bank (p + k) % N_BANKS (rotated
+    //    by the datapath). Needs M, N <= N_BANKS, K a multiple of N_BANKS and the
+    //    plain GEMM schedule (no SMALL_MATRIX, K_SPLIT, GEMV, STREAM_K_SLOTS, CONV or AGU jobs)
+    parameter SKEW = 0,
+
+    // Row groups per K step: with M or N > N_BANKS, bank b holds A rows b, b + N_BANKS, ...
+    //    (row i at address (i / N_BANKS) * K + k) and B columns likewise (column j at
+    //    address k * ceil(N/N_BANKS) + j / N_BANKS). Every K step then takes ROW_GROUPS
+    //    cycles, one bank read per group; the datapath stages the earlier groups and
+    //    the PE step is issued with the last one (Must match datapath; plain GEMM
+    //    schedule only: no SMALL_MATRIX, K_SPLIT, GEMV, BIT_SERIAL, STREAM_K_SLOTS,
+    //    CONV, AGU or SKEW jobs)
+    parameter ROW_GROUPS = ((M > N ? M : N) + N_BANKS - 1) / N_BANKS,
+
+    // 1: datapath controls are driven directly from flops, decoded one cycle ahead
+    //    from the next state/counter values. 0: decoded combinationally from the
+    //    current state. Both produce cycle-identical outputs.
+    parameter REGISTERED_OUTPUTS = 1
     )
    (
     input wire                                                                                         clk,                        // Clock signal
     input wire                                                                                         rst_n,                      // Asynchronous active-low reset (connect to datapath clr_n)
     input wire                                                                                         start_mult,                 // Start signal from external system
+    input wire [$clog2(DATA_WIDTH+1)-1:0]                                                              precision,                  // BIT_SERIAL: B bit planes per job, sampled at start (0 = DATA_WIDTH)
+    input wire [7:0]                                                                                   c_targets,                  // STRASSEN: per C block b, bits [2b+1:2b] = 0 skip, 1 write, 2 add, 3 subtract (sampled at start)
+    input wire                                                                                         k_stall,                    // K_STALL: operands not available, insert a bubble in the next K step
+    input wire                                                                                         slice_valid,                // STREAM_K_SLOTS: the loader has written slot 'slice_slot' (pulse)
+    input wire [((K > 1) ? $clog2(K) : 1)-1:0]                                                         slice_slot,                 // STREAM_K_SLOTS: slot of the completed slice
+    output wire [((STREAM_K_SLOTS > 0) ? STREAM_K_SLOTS : 1)-1:0]                                      slice_free,                 // STREAM_K_SLOTS: slots the loader may (over)write
+    input wire                                                                                         agu_en,                     // AGU: address the job through the agu_* fields (sampled at start, as are the fields)
+    input wire [(((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K + CONV_IFM_DEPTH) : 1)-1:0]                agu_a_base,                 // AGU: A address of row 0, k 0
+    input wire [(((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K + CONV_IFM_DEPTH) : 1)-1:0]                agu_a_stride_r,             // AGU: A address step per row (bank)
+    input wire [(((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K + CONV_IFM_DEPTH) : 1)-1:0]                agu_a_stride_k,             // AGU: A address step per k
+    input wire [((K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1)-1:0]                                 agu_b_base,                 // AGU: B address of column 0, k 0
+    input wire [((K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1)-1:0]                                 agu_b_stride_c,             // AGU: B address step per column (bank)
+    input wire [((K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1)-1:0]                                 agu_b_stride_k,             // AGU: B address step per k
+    input wire [((M * N > 0) ? $clog2(M * N * (STRASSEN ? 4 : 1)) : 1)-1:0]                            agu_c_base,                 // AGU: C address of element (0, 0)
+    input wire [((M * N > 0) ? $clog2(M * N * (STRASSEN ? 4 : 1)) : 1)-1:0]                            agu_c_stride_r,             // AGU: C address step per row
+    input wire [((M * N > 0) ? $clog2(M * N * (STRASSEN ? 4 : 1)) : 1)-1:0]                            agu_c_stride_c,             // AGU: C address step per column
+    input wire [$clog2(K):0]                                                                           agu_k_len,                  // AGU: K steps of the job (0 = K)
+    input wire [$clog2(M+1)-1:0]                                                                       agu_m_len,                  // AGU: C rows written back (0 = M)
+    input wire [$clog2(N+1)-1:0]                                                                       agu_n_len,                  // AGU: C columns written back (0 = N)
+    input wire                                                                                         transpose_a,                // SKEW: the job uses A = S^T of the stored A matrix (sampled at start)
+    input wire                                                                                         transpose_b,                // SKEW: the job uses B = S^T of the stored B matrix (sampled at start)
+    input wire                                                                                         conv_en,                    // CONV: the job is a convolution (sampled at start, as are the conv_* fields)
+    input wire [CONV_DIM_WIDTH-1:0]                                                                    conv_in_w,                  // CONV: IFM width W
+    input wire [CONV_DIM_WIDTH-1:0]                                                                    conv_in_h,                  // CONV: IFM height H
+    input wire [CONV_DIM_WIDTH-1:0]                                                                    conv_in_c,                  // CONV: IFM channels C (steps past C*kh*kw read as padding)
+    input wire [3:0]                                                                                   conv_kw,                    // CONV: kernel width kw
+    input wire [3:0]                                                                                   conv_kh,                    // CONV: kernel height kh
+    input wire [2:0]                                                                                   conv_stride,                // CONV: stride S
+    input wire [2:0]                                                                                   conv_pad,                   // CONV: zero padding P on every side
+    input wire [CONV_DIM_WIDTH-1:0]                                                                    conv_ox,                    // CONV: output column of PE row 0
+    input wire [CONV_DIM_WIDTH-1:0]                                                                    conv_oy,                    // CONV: output row of the job
 
     // Status Inputs from Datapath
-    input wire [(PE_ROWS * PE_COLS)-1:0]                                                               pe_outputs_valid_out,       // Flattened PE output_valid signals
+    input wire [(PE_ROWS * PE_COLS)-1:0]                                                               pe_outputs_valid_out,       // Flattened PE output_valid signals (simulation check only)
     input wire                                                                                         pe_output_buffer_valid_out, // Flag indicating valid data in the buffer
 
     // Control Outputs to Datapath
     output reg [$clog2(K)-1:0]                                                                         k_idx_in,                   // Current index for accumulation (0 to K-1)
+    output reg [((DATA_WIDTH > 1) ? $clog2(DATA_WIDTH) : 1)-1:0]                                       pe_bit_idx_in,              // BIT_SERIAL: B bit plane of the current step (tracks k_idx_in)
+    output reg [((ROW_GROUPS > 1) ? $clog2(ROW_GROUPS) : 1)-1:0]                                       grp_idx_in,                 // ROW_GROUPS: row group of the operands on the BRAM outputs (tracks k_idx_in)
 
     output reg                                                                                         en_a_brams_in,              // Enable for A banks
-    output reg [N_BANKS * ($clog2(N_BANKS) + ((M/N_BANKS * K > 0) ? $clog2(M/N_BANKS * K) : 1)) - 1:0] addr_a_brams_in,            // Address for A banks
+    output reg [N_BANKS * ($clog2(N_BANKS) + (((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K + CONV_IFM_DEPTH) : 1)) - 1:0] addr_a_brams_in,            // Address for A banks
     output reg                                                                                         we_a_brams_in,              // Write enable for A banks (kept low during mult execution)
+    output reg [N_BANKS-1:0]                                                                           a_pad_in,                   // CONV: per A bank, the read addresses a padding pixel (operand is 0)
 
     output reg                                                                                         en_b_brams_in,              // Enable for B banks
-    output reg [N_BANKS * ($clog2(N_BANKS) + ((K * N/N_BANKS > 0) ? $clog2(K * N/N_BANKS) : 1)) - 1:0] addr_b_brams_in,            // Address for B banks
+    output reg [N_BANKS * ($clog2(N_BANKS) + ((K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1)) - 1:0] addr_b_brams_in,            // Address for B banks
     output reg                                                                                         we_b_brams_in,              // Write enable for B banks (kept low during mult execution)
 
     output reg                                                                                         en_c_bram_in,               // Enable for writing to C BRAM
     output reg                                                                                         we_c_bram_in,               // Write enable for C BRAM
-    output reg [((M * N > 0) ? $clog2(M * N) : 1)-1:0]                                                 addr_c_bram_in,             // Address for writing to C BRAM
+    output reg [((M * N > 0) ? $clog2(M * N * (STRASSEN ? 4 : 1)) : 1)-1:0]                            addr_c_bram_in,             // Address for writing to C BRAM
     output reg [$clog2(PE_ROWS*PE_COLS)-1:0]                                                           pe_write_idx_in,            // Index for writing PE outputs from buffer (0 to PE_ROWS*PE_COLS-1)
+    output reg [1:0]                                                                                   c_op_in,                    // C write operation: 0/1 write, 2 add to, 3 subtract from the stored value
 
     output reg                                                                                         pe_start_in,                // Start signal for PEs (initialize accumulation)
     output reg                                                                                         pe_valid_in_in,             // Valid input signal for PEs
     output reg                                                                                         pe_last_in,                 // Last input signal for PEs
+    output reg [PE_ROWS-1:0]                                                                           pe_row_en,                  // PE row clock enables (job rows, ACCUMULATE..CAPTURE_OUTPUT)
+    output reg [PE_COLS-1:0]                                                                           pe_col_en,                  // PE column clock enables (job columns, ACCUMULATE..CAPTURE_OUTPUT)
 
     output reg                                                                                         pe_output_capture_en,       // Enable to capture PE outputs into buffer
     output reg                                                                                         pe_output_buffer_reset,     // Reset the PE output buffer
@@ -47,22 +171,71 @@ module controller
     output reg                                                                                         mult_done                   // Signal indicating multiplication is complete
     );
 
-   parameter ADDR_WIDTH_A = ($clog2(N_BANKS) + ((M/N_BANKS * K > 0) ? $clog2(M/N_BANKS * K) : 1));
-   parameter ADDR_WIDTH_B = ($clog2(N_BANKS) + ((K * N/N_BANKS > 0) ? $clog2(K * N/N_BANKS) : 1));
-   parameter ADDR_WIDTH_A_BANK = (M/N_BANKS * K > 0) ? $clog2(M/N_BANKS * K) : 1;
-   parameter ADDR_WIDTH_B_BANK = (K * N/N_BANKS > 0) ? $clog2(K * N/N_BANKS) : 1;
-   parameter ADDR_WIDTH_C = (M * N > 0) ? $clog2(M * N) : 1;
+   parameter ADDR_WIDTH_A = ($clog2(N_BANKS) + (((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K + CONV_IFM_DEPTH) : 1));
+   parameter ADDR_WIDTH_B = ($clog2(N_BANKS) + ((K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1));
+   parameter ADDR_WIDTH_A_BANK = ((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K + CONV_IFM_DEPTH) : 1;
+   parameter ADDR_WIDTH_B_BANK = (K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1;
+   parameter ADDR_WIDTH_C = (M * N > 0) ? $clog2(M * N * (STRASSEN ? 4 : 1)) : 1;
    parameter ACC_WIDTH_PE = DATA_WIDTH * 2 + ((K > 1) ? $clog2(K) : 1); // PE accumulator width must match
    parameter ADDR_WIDTH_BANK = $clog2(N_BANKS); // Width of the bank index in the new address format
 
-   // PE pipeline latency from input registration to output_valid high
-   localparam PE_ACC_LATENCY = 3;
+   // Latency from the last pe_valid_in_in to PE output_valid high: the
+   // distribution trees plus the PE pipeline (plus the K-split adder).
+   // WAIT_PE_DONE is scheduled from this instead of AND-reducing every PE's
+   // output_valid, which keeps the wide reduce off the timing path.
+   localparam K_STEPS = (K + K_SPLIT - 1) / K_SPLIT; // Accumulation steps per K slice
+
+   // ROW_GROUPS: k_step_cnt counts cycles of the K loop, K step k_step_cnt / ROW_GROUPS
+   // of row group k_step_cnt % ROW_GROUPS. The A/B banks are only read for the groups
+   // they hold, so the last group read stays on their outputs until the PE step.
+   localparam A_GROUPS = (M + N_BANKS - 1) / N_BANKS; // A rows per bank
+   localparam B_GROUPS = (N + N_BANKS - 1) / N_BANKS; // B columns per bank
+   localparam GRP_WIDTH = (ROW_GROUPS > 1) ? $clog2(ROW_GROUPS) : 1;
+   localparam CYC_WIDTH = $clog2(K * ROW_GROUPS) + 1; // Width of the K-loop cycle counters
+
+   // Streaming K slot scoreboard size (one unused slot when off)
+   localparam SLOTS = (STREAM_K_SLOTS > 0) ? STREAM_K_SLOTS : 1;
+   localparam KSPLIT_LATENCY = (K_SPLIT > 1) ? 1 : 0; // Datapath partial-sum adder stages
+   localparam PE_ACC_LATENCY = BCAST_DEPTH + PE_PIPE_DEPTH + KSPLIT_LATENCY;
+   localparam N_RESULTS = (GEMV && M < PE_ROWS*PE_COLS) ? M : PE_ROWS*PE_COLS; // C elements written back
+   localparam DRAIN_CNT_WIDTH = (PE_ACC_LATENCY > 1) ? $clog2(PE_ACC_LATENCY) : 1;
+
+   // Operands are fetched BRAM_RD_LATENCY steps ahead of the step fed to the
+   // PEs: PRE_FETCH_BRAM lasts BRAM_RD_LATENCY cycles and issues addresses
+   // 0..BRAM_RD_LATENCY-1, ACCUMULATE step k issues address k + BRAM_RD_LATENCY.
+   localparam PREFETCH_CNT_WIDTH = (BRAM_RD_LATENCY > 1) ? $clog2(BRAM_RD_LATENCY) : 1;
+
+   // BIT_SERIAL: plane_cnt counts down from the top plane (precision - 1) to 0;
+   // k_step_cnt wraps to 0 at the end of every plane but the last. Without
+   // BIT_SERIAL there is a single plane 0 and the schedule is unchanged.
+   localparam PLANE_CNT_WIDTH = (DATA_WIDTH > 1) ? $clog2(DATA_WIDTH) : 1;
+
+   // C writeback targets: block b (0..3) at C addresses b*M*N .. b*M*N + N_RESULTS-1.
+   // Without STRASSEN (or with c_targets == 0) only block 0 is written.
+   localparam [7:0] C_TARGETS_DEFAULT = 8'b01;
+
+   // CONV: IFM coordinates are tracked signed (MSB set = above/left of the
+   // IFM) with room for oy*S and the kernel/row offsets
+   localparam CONV_COORD_WIDTH = CONV_DIM_WIDTH + 4;
+
+   // First block after 'from' selected in 'tgt', or 4 if there is none
+   function integer next_c_block;
+      input [7:0]   tgt;
+      input integer from;
+      integer       b;
+      begin
+         next_c_block = 4;
+         for (b = 3; b >= 0; b = b - 1)
+           if (b > from && tgt[2*b +: 2] != 2'b00)
+             next_c_block = b;
+      end
+   endfunction
 
    // State Machine Definition using localparam
    localparam [3:0] // Adjust width based on the number of states (8 states -> 4 bits needed)
                     IDLE             = 4'd0, // Waiting for start_mult
                     RESET_BUFFER     = 4'd1, // Resetting the PE output buffer
-                    PRE_FETCH_BRAM   = 4'd2, // Initiate BRAM read for k_step = 0
+                    PRE_FETCH_BRAM   = 4'd2, // Initiate BRAM reads for the first BRAM_RD_LATENCY k steps
                     ACCUMULATE       = 4'd3, // Feeding inputs to PEs for K cycles
                     WAIT_PE_DONE     = 4'd4, // Waiting for PEs to signal valid outputs
                     CAPTURE_OUTPUT   = 4'd5, // Pulsing capture enable
@@ -73,9 +246,99 @@ module controller
    reg [3:0]        current_state, next_state; // State registers
 
    // Internal Registers
-   reg [$clog2(K):0] k_step_cnt; // Counter for accumulation steps (0 to K)
-   reg [$clog2(PE_ROWS*PE_COLS):0] write_c_cnt; // Counter for writing to C BRAM (0 to PE_ROWS*PE_COLS)
+   reg [CYC_WIDTH-1:0] k_step_cnt, k_step_cnt_nxt; // Counter for accumulation cycles (0 to K * ROW_GROUPS)
+   reg [$clog2(PE_ROWS*PE_COLS):0] write_c_cnt, write_c_cnt_nxt; // Counter for writing to C BRAM (0 to PE_ROWS*PE_COLS)
+   reg [DRAIN_CNT_WIDTH-1:0]       drain_cnt, drain_cnt_nxt; // Counter for PE pipeline drain cycles (0 to PE_ACC_LATENCY-1)
+   reg [PREFETCH_CNT_WIDTH-1:0]    prefetch_cnt, prefetch_cnt_nxt; // Counter for prefetch cycles (0 to BRAM_RD_LATENCY-1)
+   reg [PLANE_CNT_WIDTH-1:0]       plane_cnt, plane_cnt_nxt; // Current B bit plane (top plane down to 0)
+   reg [PLANE_CNT_WIDTH-1:0]       plane_top, plane_top_nxt; // First (most significant) plane of the job
+   reg [1:0]                       c_block, c_block_nxt; // C block being written
+   reg [7:0]                       c_tgt, c_tgt_nxt; // C writeback targets of the job
+   reg                             k_bubble, k_bubble_nxt; // K_STALL: this ACCUMULATE cycle issues no step
+   reg [$clog2(K):0]               k_len, k_len_nxt; // K steps of the job (K_STEPS unless set by the AGU)
+   reg                             ag_en; // AGU: the running job uses the agu_* addressing
+   reg [ADDR_WIDTH_A_BANK-1:0]     ag_a_base, ag_a_sr, ag_a_sk; // A base, row and k strides of the job
+   reg [ADDR_WIDTH_B_BANK-1:0]     ag_b_base, ag_b_sc, ag_b_sk; // B base, column and k strides of the job
+   reg [ADDR_WIDTH_C-1:0]          ag_c_base, ag_c_sr, ag_c_sc; // C base, row and column strides of the job
+   reg [$clog2(M+1)-1:0]           ag_m_len; // C rows/columns written back
+   reg [$clog2(N+1)-1:0]           ag_n_len;
+   reg                             sk_tr_a, sk_tr_b; // SKEW: transpose flags of the job
+   integer                         sk_p; // SKEW: PE row/column a bank serves in the fetched step (decode temporary)
+   wire [SLOTS-1:0]                slot_avail; // STREAM_K_SLOTS: slots holding an unread slice, not being read this cycle
+   reg [$clog2(K)+1:0]             stream_fetch_k; // Step the next cycle will fetch
+   reg                             stream_wait; // That step's slice has not arrived yet
+   reg                             cv_en; // CONV: the running job is a convolution
+   reg [CONV_DIM_WIDTH-1:0]        cv_w, cv_h, cv_c; // IFM width/height/channels of the job
+   reg [CONV_DIM_WIDTH-1:0]        cv_ch; // Input channel of the next A fetch
+   reg [3:0]                       cv_kw, cv_kh; // Kernel size of the job
+   reg [2:0]                       cv_s; // Stride of the job
+   reg [3:0]                       cv_kx, cv_ky; // Kernel column/row of the next A fetch
+   reg [CONV_COORD_WIDTH-1:0]      cv_iy0, cv_iy; // IFM row of kernel row 0 / of the next A fetch
+   reg [CONV_COORD_WIDTH-1:0]      cv_ix0; // IFM column of PE row 0 at kernel column 0
+   reg [ADDR_WIDTH_A_BANK-1:0]     cv_row0, cv_row; // cv_iy0*W / cv_iy*W (modulo the bank depth)
+   reg [ADDR_WIDTH_A_BANK-1:0]     cv_hw, cv_c_off; // H*W / c*H*W of the next A fetch
+   reg [CONV_COORD_WIDTH-1:0]      cv_ix; // IFM column of a bank's PE row (decode temporary)
    integer                         bank_idx; // Loop variable for address calculation
+   integer                         en_idx;   // Loop variable for the PE clock enables
+
+   // Decoder inputs: the state/counters the outputs are decoded from.
+   // With REGISTERED_OUTPUTS the decode looks one cycle ahead (next values)
+   // and the result is registered, so the outputs equal the combinational
+   // decode of the current state but come straight from flops.
+   wire [3:0]                      dec_state;
+   wire [CYC_WIDTH-1:0]            dec_k_cnt;
+   wire [$clog2(PE_ROWS*PE_COLS):0] dec_write_cnt;
+   wire [PREFETCH_CNT_WIDTH-1:0]   dec_prefetch_cnt;
+   wire [PLANE_CNT_WIDTH-1:0]      dec_plane_cnt;
+   wire [PLANE_CNT_WIDTH-1:0]      dec_plane_top;
+   wire [1:0]                      dec_c_block;
+   wire [7:0]                      dec_c_tgt;
+   wire                            dec_k_bubble;
+   wire [$clog2(K):0]              dec_k_len;
+
+   assign dec_state = REGISTERED_OUTPUTS ? next_state : current_state;
+   assign dec_k_cnt = REGISTERED_OUTPUTS ? k_step_cnt_nxt : k_step_cnt;
+   assign dec_write_cnt = REGISTERED_OUTPUTS ? write_c_cnt_nxt : write_c_cnt;
+   assign dec_prefetch_cnt = REGISTERED_OUTPUTS ? prefetch_cnt_nxt : prefetch_cnt;
+   assign dec_plane_cnt = REGISTERED_OUTPUTS ? plane_cnt_nxt : plane_cnt;
+   assign dec_plane_top = REGISTERED_OUTPUTS ? plane_top_nxt : plane_top;
+   assign dec_c_block = REGISTERED_OUTPUTS ? c_block_nxt : c_block;
+   assign dec_c_tgt = REGISTERED_OUTPUTS ? c_tgt_nxt : c_tgt;
+   assign dec_k_bubble = REGISTERED_OUTPUTS ? k_bubble_nxt : k_bubble;
+   assign dec_k_len = REGISTERED_OUTPUTS ? k_len_nxt : k_len;
+
+   // AGU: row/column of the C element being written
+   wire [$clog2(PE_ROWS+1)-1:0]    ag_i;
+   wire [$clog2(PE_COLS+1)-1:0]    ag_j;
+
+   assign ag_i = dec_write_cnt / PE_COLS;
+   assign ag_j = dec_write_cnt % PE_COLS;
+
+   // Decoded output values (see output stage below)
+   reg [$clog2(K)-1:0]                 dec_k_idx;
+   reg [GRP_WIDTH-1:0]                 dec_grp_idx;
+   reg [PLANE_CNT_WIDTH-1:0]           dec_pe_bit_idx;
+   reg                                 dec_en_a_brams;
+   reg [N_BANKS-1:0]                   dec_a_pad;
+   reg [N_BANKS * ADDR_WIDTH_A - 1:0]  dec_addr_a_brams;
+   reg                                 dec_en_b_brams;
+   reg [N_BANKS * ADDR_WIDTH_B - 1:0]  dec_addr_b_brams;
+   reg                                 dec_en_c_bram;
+   reg                                 dec_we_c_bram;
+   reg [ADDR_WIDTH_C-1:0]              dec_addr_c_bram;
+   reg [$clog2(PE_ROWS*PE_COLS)-1:0]   dec_pe_write_idx;
+   reg [1:0]                           dec_c_op;
+   reg                                 dec_pe_start;
+   reg                                 dec_pe_valid_in;
+   reg                                 dec_pe_last;
+   reg                                 dec_pe_active; // PE pipelines must clock (feeding or draining)
+   reg [PE_ROWS-1:0]                   dec_pe_row_en;
+   reg [PE_COLS-1:0]                   dec_pe_col_en;
+   reg                                 dec_pe_output_capture_en;
+   reg                                 dec_pe_output_buffer_reset;
+   reg                                 dec_mult_done;
+   integer                             dec_fetch_k; // K-loop cycle whose operands are addressed this cycle
+   integer                             fetch_k, fetch_grp; // Its k step and row group
 
 
    // State Transition Logic (Synchronous)
@@ -84,125 +347,229 @@ module controller
         if (!rst_n)
           begin
              current_state <= IDLE;
+             k_step_cnt <= 0;
+             write_c_cnt <= 0;
+             drain_cnt <= 0;
+             prefetch_cnt <= 0;
+             plane_cnt <= 0;
+             plane_top <= 0;
+             c_block <= 0;
+             c_tgt <= C_TARGETS_DEFAULT;
+             k_bubble <= 1'b0;
+             k_len <= K_STEPS;
           end
         else
           begin
              current_state <= next_state;
+             k_step_cnt <= k_step_cnt_nxt;
+             write_c_cnt <= write_c_cnt_nxt;
+             drain_cnt <= drain_cnt_nxt;
+             prefetch_cnt <= prefetch_cnt_nxt;
+             plane_cnt <= plane_cnt_nxt;
+             plane_top <= plane_top_nxt;
+             c_block <= c_block_nxt;
+             c_tgt <= c_tgt_nxt;
+             k_bubble <= k_bubble_nxt;
+             k_len <= k_len_nxt;
           end
      end
 
-   // Next State Logic (Combinational) and Output Logic (Combinational/Synchronous)
+   // Streaming K scoreboard. A slot is freed by the cycle that reads it (the
+   // current BRAM read, bank 0's in-bank address) and set by the loader's
+   // slice_valid; a slot freed this cycle cannot be read again before it is
+   // rewritten.
+   generate
+      if (STREAM_K_SLOTS > 0)
+        begin : stream_k_gen
+           reg [SLOTS-1:0]  slot_valid; // Slots holding a slice not yet read
+           wire [SLOTS-1:0] slot_rd = en_a_brams_in ? ({{(SLOTS-1){1'b0}}, 1'b1} << (addr_a_brams_in[ADDR_WIDTH_A_BANK-1:0] % SLOTS)) : {SLOTS{1'b0}};
+           wire [SLOTS-1:0] slot_wr = slice_valid ? ({{(SLOTS-1){1'b0}}, 1'b1} << slice_slot) : {SLOTS{1'b0}};
+
+           always @(posedge clk or negedge rst_n)
+             begin
+                if (!rst_n)
+                  slot_valid <= 'b0;
+                else
+                  slot_valid <= (slot_valid & ~slot_rd) | slot_wr;
+             end
+
+           assign slot_avail = slot_valid & ~slot_rd;
+           assign slice_free = ~slot_valid;
+        end
+      else
+        begin : no_stream_k_gen
+           assign slot_avail = 'b0;
+           assign slice_free = 'b0;
+        end
+   endgenerate
+
+   // Next cycle's fetch (steps one BRAM latency ahead of k_step_cnt_nxt), and
+   // whether its slice is still missing
+   always @(*)
+     begin
+        stream_fetch_k = k_step_cnt_nxt + BRAM_RD_LATENCY;
+        stream_wait = (STREAM_K_SLOTS > 0) && (stream_fetch_k < K_STEPS) && !slot_avail[stream_fetch_k % SLOTS];
+     end
+
+   // CONV: im2col position of the next A fetch. Fetches are decoded in k
+   // order, one per step, so the walk (kx fastest, then ky, then the channel)
+   // advances on every decoded fetch; dec_en_a_brams is only high in the job.
+   always @(posedge clk or negedge rst_n)
+     begin
+        if (!rst_n)
+          begin
+             cv_en <= 1'b0;
+             cv_w <= 0;
+             cv_h <= 0;
+             cv_c <= 0;
+             cv_ch <= 0;
+             cv_kw <= 0;
+             cv_kh <= 0;
+             cv_s <= 0;
+             cv_kx <= 0;
+             cv_ky <= 0;
+             cv_iy0 <= 0;
+             cv_iy <= 0;
+             cv_ix0 <= 0;
+             cv_row0 <= 0;
+             cv_row <= 0;
+             cv_hw <= 0;
+             cv_c_off <= 0;
+          end
+        else if (current_state == IDLE && start_mult)
+          begin
+             // Sample the job's geometry, start at (c, ky, kx) = (0, 0, 0)
+             cv_en <= CONV && conv_en;
+             cv_w <= conv_in_w;
+             cv_h <= conv_in_h;
+             cv_c <= conv_in_c;
+             cv_ch <= 0;
+             cv_kw <= conv_kw;
+             cv_kh <= conv_kh;
+             cv_s <= conv_stride;
+             cv_kx <= 0;
+             cv_ky <= 0;
+             cv_iy0 <= conv_oy * conv_stride - conv_pad;
+             cv_iy <= conv_oy * conv_stride - conv_pad;
+             cv_ix0 <= conv_ox * conv_stride - conv_pad;
+             cv_row0 <= (conv_oy * conv_stride - conv_pad) * conv_in_w;
+             cv_row <= (conv_oy * conv_stride - conv_pad) * conv_in_w;
+             cv_hw <= conv_in_w * conv_in_h;
+             cv_c_off <= 0;
+          end
+        else if (cv_en && dec_en_a_brams)
+          begin
+             if (cv_kx + 1 < cv_kw)
+               begin
+                  cv_kx <= cv_kx + 1;
+               end
+             else if (cv_ky + 1 < cv_kh)
+               begin
+                  cv_kx <= 0;
+                  cv_ky <= cv_ky + 1;
+                  cv_iy <= cv_iy + 1;
+                  cv_row <= cv_row + cv_w;
+               end
+             else
+               begin
+                  // Next input channel
+                  cv_kx <= 0;
+                  cv_ky <= 0;
+                  cv_iy <= cv_iy0;
+                  cv_row <= cv_row0;
+                  cv_c_off <= cv_c_off + cv_hw;
+                  if (cv_ch < cv_c)
+                    cv_ch <= cv_ch + 1;
+               end
+          end
+     end
+
+   // AGU: base/stride/bound registers of the job, sampled at start
+   always @(posedge clk or negedge rst_n)
+     begin
+        if (!rst_n)
+          begin
+             ag_en <= 1'b0;
+             ag_a_base <= 0;
+             ag_a_sr <= 0;
+             ag_a_sk <= 0;
+             ag_b_base <= 0;
+             ag_b_sc <= 0;
+             ag_b_sk <= 0;
+             ag_c_base <= 0;
+             ag_c_sr <= 0;
+             ag_c_sc <= 0;
+             ag_m_len <= M;
+             ag_n_len <= N;
+          end
+        else if (current_state == IDLE && start_mult)
+          begin
+             ag_en <= AGU && agu_en;
+             ag_a_base <= agu_a_base;
+             ag_a_sr <= agu_a_stride_r;
+             ag_a_sk <= agu_a_stride_k;
+             ag_b_base <= agu_b_base;
+             ag_b_sc <= agu_b_stride_c;
+             ag_b_sk <= agu_b_stride_k;
+             ag_c_base <= agu_c_base;
+             ag_c_sr <= agu_c_stride_r;
+             ag_c_sc <= agu_c_stride_c;
+             ag_m_len <= (agu_m_len == 0 || agu_m_len > M) ? M : agu_m_len;
+             ag_n_len <= (agu_n_len == 0 || agu_n_len > N) ? N : agu_n_len;
+          end
+     end
+
+   // SKEW: transpose flags of the job, sampled at start
+   always @(posedge clk or negedge rst_n)
+     begin
+        if (!rst_n)
+          begin
+             sk_tr_a <= 1'b0;
+             sk_tr_b <= 1'b0;
+          end
+        else if (current_state == IDLE && start_mult)
+          begin
+             sk_tr_a <= SKEW && transpose_a;
+             sk_tr_b <= SKEW && transpose_b;
+          end
+     end
+
+   // Next State Logic (Combinational)
    always @(*)
      begin
-        // Default values for outputs to avoid latches
         next_state = current_state;
-        k_idx_in = k_step_cnt; // k_idx_in tracks the current step being fed
-        en_a_brams_in = 'b0;
-        addr_a_brams_in = 'b0;
-        we_a_brams_in = 'b0; // Keep write enables low during execution
-        en_b_brams_in = 'b0;
-        addr_b_brams_in = 'b0;
-        we_b_brams_in = 'b0; // Keep write enables low during execution
-        en_c_bram_in = 1'b0;
-        we_c_bram_in = 1'b0;
-        addr_c_bram_in = 'b0;
-        pe_write_idx_in = write_c_cnt; // pe_write_idx_in tracks the current element being written
-        pe_start_in = 1'b0;
-        pe_valid_in_in = 1'b0;
-        pe_last_in = 1'b0;
-        pe_output_capture_en = 1'b0;
-        pe_output_buffer_reset = 1'b0;
-        mult_done = 1'b0;
 
         case (current_state)
           IDLE: begin
              if (start_mult) begin
-                next_state = RESET_BUFFER;
+                // Counters are already cleared on DONE -> IDLE
+                next_state = SMALL_MATRIX ? ACCUMULATE : RESET_BUFFER;
              end
           end
 
           RESET_BUFFER: begin
-             pe_output_buffer_reset = 1'b1; // Assert reset for one cycle
-             next_state = PRE_FETCH_BRAM; // Transition to pre-fetch state
+             // Transition to pre-fetch state (streaming K: once the first slice has arrived)
+             if (STREAM_K_SLOTS == 0 || slot_avail[0]) begin
+                next_state = PRE_FETCH_BRAM;
+             end else begin
+                next_state = RESET_BUFFER;
+             end
           end
 
           PRE_FETCH_BRAM: begin
-             pe_output_buffer_reset = 1'b0; // Deassert reset
-
-             // Initiate BRAM read for k_step = 0
-             // Set BRAM addresses and enables for the first input cycle (k_step = 0)
-             en_a_brams_in = 1'b1;
-             we_a_brams_in = 1'b0;
-             en_b_brams_in = 1'b1;
-             we_b_brams_in = 1'b0;
-
-             for (bank_idx = 0; bank_idx < N_BANKS; bank_idx = bank_idx + 1)
-               begin
-                  // Address for A
-                  // addr in bank
-                  addr_a_brams_in[bank_idx * ADDR_WIDTH_A + ADDR_WIDTH_A_BANK - 1 -: ADDR_WIDTH_A_BANK] = 0;
-
-                  // bank idx
-                  addr_a_brams_in[bank_idx * ADDR_WIDTH_A + ADDR_WIDTH_A - 1 -: ADDR_WIDTH_BANK] = bank_idx;
-
-                  // Address for B
-                  // addr in bank
-                  addr_b_brams_in[bank_idx * ADDR_WIDTH_B + ADDR_WIDTH_B_BANK - 1 -: ADDR_WIDTH_B_BANK] = 0;
-
-                  // bank idx
-                  addr_b_brams_in[bank_idx * ADDR_WIDTH_B + ADDR_WIDTH_B - 1 -: ADDR_WIDTH_BANK] = bank_idx;
-               end // for (bank_idx = 0; bank_idx < N_BANKS; bank_idx = bank_idx + 1)
-             #1;
-
-             next_state = ACCUMULATE; // Transition to accumulate after one cycle (BRAM read initiated)
+             // Transition to accumulate once the first step's read data is BRAM_RD_LATENCY cycles away
+             if (prefetch_cnt == BRAM_RD_LATENCY - 1) begin
+                next_state = ACCUMULATE;
+             end else begin
+                next_state = PRE_FETCH_BRAM;
+             end
           end
 
           ACCUMULATE: begin
-             pe_output_buffer_reset = 1'b0; // Keep reset deasserted
-
-             // Drive PE control signals for the current k_step_cnt
-             pe_valid_in_in = 1'b1;
-             pe_start_in = (k_step_cnt == 0); // Start only on the first step (when k_step_cnt is 0)
-             pe_last_in = (k_step_cnt == K - 1); // Last only on the final step
-
-             // Drive BRAM Read Addresses and Enables for the *next* k_step_cnt + 1
-             // Data for k_step_cnt is available from BRAMs from the previous cycle's address.
-             // Now set addresses for the next cycle (k_step_cnt + 1).
-             if (k_step_cnt < K - 1)
-               begin // Only set addresses for the next step if it exists
-                  en_a_brams_in = 1'b1;
-                  en_b_brams_in = 1'b1;
-
-                  for (bank_idx = 0; bank_idx < N_BANKS; bank_idx = bank_idx + 1)
-                    begin
-                       // Address for A
-                       // addr in bank
-                       addr_a_brams_in[bank_idx * ADDR_WIDTH_A + ADDR_WIDTH_A_BANK - 1 -: ADDR_WIDTH_A_BANK] = k_step_cnt + 1;
-
-                       // bank idx
-                       addr_a_brams_in[bank_idx * ADDR_WIDTH_A + ADDR_WIDTH_A - 1 -: ADDR_WIDTH_BANK] = bank_idx;
-
-                       // Address for B
-                       // addr in bank
-                       addr_b_brams_in[bank_idx * ADDR_WIDTH_B + ADDR_WIDTH_B_BANK - 1 -: ADDR_WIDTH_B_BANK] = k_step_cnt + 1;
-
-                       // bank idx
-                       addr_b_brams_in[bank_idx * ADDR_WIDTH_B + ADDR_WIDTH_B - 1 -: ADDR_WIDTH_BANK] = bank_idx;
-                    end
-                  #1;
-               end
-             else
-               begin
-                  // On the last accumulation step (k_step_cnt == K-1), deassert BRAM enables
-                  en_a_brams_in = 'b0;
-                  en_b_brams_in = 'b0;
-               end
-
-
-             if (k_step_cnt == K - 1)
+             if (k_step_cnt == k_len * ROW_GROUPS - 1 && plane_cnt == 0 && !k_bubble)
                begin
-                  // Finished feeding the last input (k_step = K-1)
-                next_state = WAIT_PE_DONE;
+                  // Finished feeding the last input (k_step = K-1 of the last plane)
+                  next_state = WAIT_PE_DONE;
                end
              else
                begin
@@ -211,34 +578,24 @@ module controller
           end
 
           WAIT_PE_DONE: begin
-             // Wait until all PE outputs are valid
-             // Deassert all PE control signals
-             pe_valid_in_in = 1'b0;
-             pe_start_in = 1'b0;
-             pe_last_in = 1'b0;
-             en_a_brams_in = 'b0; // Ensure BRAMs are disabled
-             en_b_brams_in = 'b0;
-
-             if (pe_outputs_valid_out == {(PE_ROWS * PE_COLS){1'b1}}) begin
-                next_state = CAPTURE_OUTPUT;
+             // Wait PE_ACC_LATENCY cycles for the last input to reach the accumulators
+             if (drain_cnt == PE_ACC_LATENCY - 1) begin
+                // Small-matrix results stay in the PEs and are read from there
+                next_state = SMALL_MATRIX ? DONE : CAPTURE_OUTPUT;
              end else begin
                 next_state = WAIT_PE_DONE;
              end
           end
 
           CAPTURE_OUTPUT: begin
-             pe_output_capture_en = 1'b1; // Pulse capture enable for one cycle
              next_state = WRITE_C_BRAM;
           end
 
           WRITE_C_BRAM: begin
-             pe_output_capture_en = 1'b0; // Deassert capture enable
-
-             en_c_bram_in = 1'b1;
-             we_c_bram_in = 1'b1;
-             addr_c_bram_in = write_c_cnt; // Write to flattened address
-
-             if (write_c_cnt == (PE_ROWS * PE_COLS) - 1) begin
+             if (write_c_cnt == N_RESULTS - 1 && next_c_block(c_tgt, c_block) < 4) begin
+                // Block done, write the next target block
+                next_state = WRITE_C_BRAM;
+             end else if (write_c_cnt == N_RESULTS - 1) begin
                 // Finished writing the last element
                 next_state = DONE;
              end else begin
@@ -247,11 +604,6 @@ module controller
           end
 
           DONE: begin
-             mult_done = 1'b1; // Signal completion
-             // Deassert C BRAM write signals
-             en_c_bram_in = 1'b0;
-             we_c_bram_in = 1'b0;
-
              if (!start_mult) begin // Go back to IDLE if start is deasserted
                 next_state = IDLE;
              end else begin
@@ -265,42 +617,372 @@ module controller
         endcase
      end
 
-   // Counters (Synchronous)
-   always @(posedge clk or negedge rst_n) begin
-      if (!rst_n) begin
-         k_step_cnt <= 0;
-         write_c_cnt <= 0;
-      end else begin
-         case (current_state)
-           ACCUMULATE: begin
-              // Increment k_step_cnt for each accumulation cycle
-              if (k_step_cnt < K) begin
-                 k_step_cnt <= k_step_cnt + 1;
-              end
-           end
-           WRITE_C_BRAM: begin
-              // Increment write_c_cnt for each C BRAM write cycle
-              if (write_c_cnt < (PE_ROWS * PE_COLS)) begin
-                 write_c_cnt <= write_c_cnt + 1;
-              end
-           end
-           RESET_BUFFER: begin
-              // Reset counters when starting a new multiplication
-              k_step_cnt <= 0;
-              write_c_cnt <= 0;
-           end
-           DONE: begin
-              // Reset counters when going back to IDLE
-              if (next_state == IDLE) begin
-                 k_step_cnt <= 0;
-                 write_c_cnt <= 0;
-              end
-           end
-           default: begin
-              // Counters hold their value in other states
-           end
-         endcase
+   // Counters (Combinational next values, registered with the state)
+   always @(*)
+     begin
+        k_step_cnt_nxt = k_step_cnt;
+        write_c_cnt_nxt = write_c_cnt;
+        drain_cnt_nxt = drain_cnt;
+        prefetch_cnt_nxt = prefetch_cnt;
+        plane_cnt_nxt = plane_cnt;
+        plane_top_nxt = plane_top;
+        c_block_nxt = c_block;
+        c_tgt_nxt = c_tgt;
+        k_bubble_nxt = 1'b0;
+        k_len_nxt = k_len;
+
+        case (current_state)
+          IDLE: begin
+             // Sample the job's C writeback targets
+             if (start_mult) begin
+                c_tgt_nxt = (STRASSEN && c_targets != 8'b0) ? c_targets : C_TARGETS_DEFAULT;
+             end
+             // Sample the job's K length
+             if (start_mult) begin
+                k_len_nxt = (AGU && agu_en && agu_k_len != 0 && agu_k_len < K_STEPS) ? agu_k_len : K_STEPS;
+             end
+             // Sample the job's precision: planes precision-1 .. 0
+             if (BIT_SERIAL && start_mult) begin
+                if (precision == 0 || precision > DATA_WIDTH) begin
+                   plane_top_nxt = DATA_WIDTH - 1;
+                end else begin
+                   plane_top_nxt = precision - 1;
+                end
+                plane_cnt_nxt = plane_top_nxt;
+             end
+          end
+          PRE_FETCH_BRAM: begin
+             // Count prefetch cycles
+             if (prefetch_cnt < BRAM_RD_LATENCY - 1) begin
+                prefetch_cnt_nxt = prefetch_cnt + 1;
+             end
+             k_bubble_nxt = ((K_STALL && k_stall) || stream_wait) && (next_state == ACCUMULATE);
+          end
+          ACCUMULATE: begin
+             k_bubble_nxt = ((K_STALL && k_stall) || stream_wait) && (next_state == ACCUMULATE);
+             // Increment k_step_cnt for each accumulation cycle (a bubble issues
+             // none); BIT_SERIAL restarts K for the next (less significant) plane
+             if (k_bubble) begin
+                k_step_cnt_nxt = k_step_cnt;
+             end else if (k_step_cnt == K_STEPS - 1 && plane_cnt != 0) begin
+                k_step_cnt_nxt = 0;
+                plane_cnt_nxt = plane_cnt - 1;
+             end else if (k_step_cnt < k_len * ROW_GROUPS) begin
+                k_step_cnt_nxt = k_step_cnt + 1;
+             end
+             drain_cnt_nxt = 0;
+          end
+          WAIT_PE_DONE: begin
+             // Count PE pipeline drain cycles
+             if (drain_cnt < PE_ACC_LATENCY - 1) begin
+                drain_cnt_nxt = drain_cnt + 1;
+             end
+          end
+          CAPTURE_OUTPUT: begin
+             // First target block of the writeback
+             c_block_nxt = next_c_block(c_tgt, -1);
+          end
+          WRITE_C_BRAM: begin
+             // Increment write_c_cnt for each C BRAM write cycle; restart it for the next target block
+             if (write_c_cnt == N_RESULTS - 1 && next_c_block(c_tgt, c_block) < 4) begin
+                write_c_cnt_nxt = 0;
+                c_block_nxt = next_c_block(c_tgt, c_block);
+             end else if (write_c_cnt < N_RESULTS) begin
+                write_c_cnt_nxt = write_c_cnt + 1;
+             end
+          end
+          RESET_BUFFER: begin
+             // Reset counters when starting a new multiplication
+             k_step_cnt_nxt = 0;
+             write_c_cnt_nxt = 0;
+             drain_cnt_nxt = 0;
+             prefetch_cnt_nxt = 0;
+          end
+          DONE: begin
+             // Reset counters when going back to IDLE
+             if (next_state == IDLE) begin
+                k_step_cnt_nxt = 0;
+                write_c_cnt_nxt = 0;
+             end
+          end
+          default: begin
+             // Counters hold their value in other states
+          end
+        endcase
+     end
+
+   // Output Decode (Combinational, from dec_state and the decoder counters)
+   always @(*)
+     begin
+        // Default values for outputs to avoid latches
+        dec_k_idx = dec_k_cnt / ROW_GROUPS; // k_idx_in tracks the current step being fed
+        dec_grp_idx = dec_k_cnt % ROW_GROUPS; // grp_idx_in tracks its row group
+        dec_pe_bit_idx = dec_plane_cnt; // pe_bit_idx_in tracks the plane of that step
+        dec_en_a_brams = 1'b0;
+        dec_addr_a_brams = 'b0;
+        dec_a_pad = 'b0;
+        dec_en_b_brams = 1'b0;
+        dec_addr_b_brams = 'b0;
+        dec_en_c_bram = 1'b0;
+        dec_we_c_bram = 1'b0;
+        dec_addr_c_bram = 'b0;
+        dec_pe_write_idx = dec_write_cnt; // pe_write_idx_in tracks the current element being written
+        dec_c_op = 2'b00;
+        dec_pe_start = 1'b0;
+        dec_pe_valid_in = 1'b0;
+        dec_pe_last = 1'b0;
+        dec_pe_active = 1'b0;
+        dec_pe_output_capture_en = 1'b0;
+        dec_pe_output_buffer_reset = 1'b0;
+        dec_mult_done = 1'b0;
+        dec_fetch_k = K_STEPS * ROW_GROUPS; // No fetch
+
+        case (dec_state)
+          RESET_BUFFER: begin
+             dec_pe_output_buffer_reset = 1'b1; // Assert reset for one cycle
+          end
+
+          PRE_FETCH_BRAM: begin
+             // Initiate BRAM reads for the first input cycles (k_step = 0 .. BRAM_RD_LATENCY-1)
+             dec_fetch_k = dec_prefetch_cnt;
+             // BIT_SERIAL: steps past K belong to the next plane(s)
+             if (BIT_SERIAL && dec_fetch_k >= K_STEPS && dec_fetch_k < (dec_plane_cnt + 1) * K_STEPS) begin
+                dec_fetch_k = dec_fetch_k % K_STEPS;
+             end
+          end
+
+          ACCUMULATE: begin
+             dec_pe_active = 1'b1;
+
+             // Drive PE control signals for the current k step (none in a bubble)
+             // (ROW_GROUPS: the step is issued with the last row group)
+             dec_pe_valid_in = !dec_k_bubble && (dec_k_cnt % ROW_GROUPS == ROW_GROUPS - 1);
+             dec_pe_start = !dec_k_bubble && (dec_k_cnt == ROW_GROUPS - 1 && dec_plane_cnt == dec_plane_top); // Start only on the first step
+             dec_pe_last = !dec_k_bubble && (dec_k_cnt == dec_k_len * ROW_GROUPS - 1 && dec_plane_cnt == 0); // Last only on the final step
+
+             // Drive BRAM read addresses for the k step BRAM_RD_LATENCY ahead.
+             // Data for the current step was addressed BRAM_RD_LATENCY cycles earlier.
+             dec_fetch_k = dec_k_cnt + BRAM_RD_LATENCY;
+             // BIT_SERIAL: steps past K belong to the next plane(s), which re-read K from 0
+             if (BIT_SERIAL && dec_fetch_k >= K_STEPS && dec_fetch_k < (dec_plane_cnt + 1) * K_STEPS) begin
+                dec_fetch_k = dec_fetch_k % K_STEPS;
+             end
+             // A bubble reads nothing, so the BRAM outputs keep the operands of step k
+             if (dec_k_bubble) begin
+                dec_fetch_k = K_STEPS * ROW_GROUPS;
+             end
+          end
+
+          WAIT_PE_DONE: begin
+             dec_pe_active = 1'b1; // PE pipelines drain
+          end
+
+          CAPTURE_OUTPUT: begin
+             dec_pe_active = 1'b1; // One more cycle clears the pipelined 'last'
+             dec_pe_output_capture_en = 1'b1; // Pulse capture enable for one cycle
+          end
+
+          WRITE_C_BRAM: begin
+             dec_en_c_bram = 1'b1;
+             dec_we_c_bram = 1'b1;
+             dec_addr_c_bram = dec_c_block * (M * N) + dec_write_cnt; // Write to flattened address in the target block
+             dec_c_op = dec_c_tgt[2*dec_c_block +: 2];
+             // AGU: C[i][j] goes to base + i*row stride + j*column stride; elements
+             // outside the agu_m_len x agu_n_len corner are not written (the enable
+             // stays high, so the datapath still sees every writeback cycle)
+             if (AGU && ag_en) begin
+                dec_addr_c_bram = ag_c_base + ag_i * ag_c_sr + ag_j * ag_c_sc;
+                dec_we_c_bram = (ag_i < ag_m_len) && (ag_j < ag_n_len);
+             end
+          end
+
+          DONE: begin
+             dec_mult_done = 1'b1; // Signal completion
+          end
+
+          default: begin
+             // IDLE: all controls deasserted
+          end
+        endcase
+
+        // BRAM read addresses and enables for K-loop cycle dec_fetch_k (if it exists):
+        // k step fetch_k, row group fetch_grp (banks without that group are not read)
+        fetch_k = dec_fetch_k / ROW_GROUPS;
+        fetch_grp = dec_fetch_k % ROW_GROUPS;
+        if (!SMALL_MATRIX && dec_fetch_k < dec_k_len * ROW_GROUPS)
+          begin
+             dec_en_a_brams = (fetch_grp < A_GROUPS);
+             dec_en_b_brams = (fetch_grp < B_GROUPS);
+
+             for (bank_idx = 0; bank_idx < N_BANKS; bank_idx = bank_idx + 1)
+               begin
+                  // Address for A
+                  // addr in bank
+                  dec_addr_a_brams[bank_idx * ADDR_WIDTH_A + ADDR_WIDTH_A_BANK - 1 -: ADDR_WIDTH_A_BANK] = (STREAM_K_SLOTS > 0) ? fetch_k % SLOTS : fetch_grp * K + fetch_k;
+
+                  // CONV: IFM pixel (cv_iy, cv_ix) of channel cv_ch for PE row bank_idx,
+                  // zeroed if it lies in the padding ring or past the last channel
+                  if (CONV && cv_en)
+                    begin
+                       cv_ix = cv_ix0 + bank_idx * cv_s + cv_kx;
+                       dec_addr_a_brams[bank_idx * ADDR_WIDTH_A + ADDR_WIDTH_A_BANK - 1 -: ADDR_WIDTH_A_BANK] = cv_c_off + cv_row + cv_ix;
+                       dec_a_pad[bank_idx] = (cv_ch >= cv_c) ||
+                                             cv_iy[CONV_COORD_WIDTH-1] || (cv_iy >= cv_h) ||
+                                             cv_ix[CONV_COORD_WIDTH-1] || (cv_ix >= cv_w);
+                    end
+
+                  // SKEW: bank bank_idx holds the operand of PE row/column sk_p. Reading
+                  // along a stored row (A, or transposed B) stays at address k; reading
+                  // down a stored column (transposed A, or B) addresses element (k, sk_p)
+                  sk_p = (bank_idx + N_BANKS - fetch_k % N_BANKS) % N_BANKS;
+                  if (SKEW && sk_tr_a)
+                    begin
+                       dec_addr_a_brams[bank_idx * ADDR_WIDTH_A + ADDR_WIDTH_A_BANK - 1 -: ADDR_WIDTH_A_BANK] = (fetch_k / N_BANKS) * M + sk_p;
+                    end
+
+                  // AGU: row bank_idx, step fetch_k of the programmed A view
+                  if (AGU && ag_en)
+                    begin
+                       dec_addr_a_brams[bank_idx * ADDR_WIDTH_A + ADDR_WIDTH_A_BANK - 1 -: ADDR_WIDTH_A_BANK] = ag_a_base + bank_idx * ag_a_sr + fetch_k * ag_a_sk;
+                    end
+
+                  // bank idx
+                  dec_addr_a_brams[bank_idx * ADDR_WIDTH_A + ADDR_WIDTH_A - 1 -: ADDR_WIDTH_BANK] = bank_idx;
+
+                  // Address for B
+                  // addr in bank
+                  dec_addr_b_brams[bank_idx * ADDR_WIDTH_B + ADDR_WIDTH_B_BANK - 1 -: ADDR_WIDTH_B_BANK] = (STREAM_K_SLOTS > 0) ? fetch_k % SLOTS : fetch_k * B_GROUPS + fetch_grp;
+
+                  if (SKEW && !sk_tr_b)
+                    begin
+                       dec_addr_b_brams[bank_idx * ADDR_WIDTH_B + ADDR_WIDTH_B_BANK - 1 -: ADDR_WIDTH_B_BANK] = (fetch_k / N_BANKS) * N + sk_p;
+                    end
+
+                  // AGU: column bank_idx, step fetch_k of the programmed B view
+                  if (AGU && ag_en)
+                    begin
+                       dec_addr_b_brams[bank_idx * ADDR_WIDTH_B + ADDR_WIDTH_B_BANK - 1 -: ADDR_WIDTH_B_BANK] = ag_b_base + bank_idx * ag_b_sc + fetch_k * ag_b_sk;
+                    end
+
+                  // bank idx
+                  dec_addr_b_brams[bank_idx * ADDR_WIDTH_B + ADDR_WIDTH_B - 1 -: ADDR_WIDTH_BANK] = bank_idx;
+               end // for (bank_idx = 0; bank_idx < N_BANKS; bank_idx = bank_idx + 1)
+          end
+        // Once the last step has been addressed BRAM enables stay deasserted
+
+        // PE clock enables: only rows/columns inside the M x N job (GEMV: holding
+        // lanes below M), and only while the PE pipelines are active
+        for (en_idx = 0; en_idx < PE_ROWS; en_idx = en_idx + 1)
+          begin
+             dec_pe_row_en[en_idx] = dec_pe_active && (GEMV ? (en_idx * PE_COLS < M) : (en_idx < M));
+          end
+        for (en_idx = 0; en_idx < PE_COLS; en_idx = en_idx + 1)
+          begin
+             dec_pe_col_en[en_idx] = dec_pe_active && (GEMV ? (en_idx < M) : (en_idx < N));
+          end
+     end
+
+   // Output Stage
+   generate
+      if (REGISTERED_OUTPUTS)
+        begin : registered_outputs_gen
+           // Outputs come directly from flops (decode was computed one cycle ahead)
+           always @(posedge clk or negedge rst_n)
+             begin
+                if (!rst_n)
+                  begin
+                     k_idx_in <= 'b0;
+                     pe_bit_idx_in <= 'b0;
+                     grp_idx_in <= 'b0;
+                     en_a_brams_in <= 1'b0;
+                     addr_a_brams_in <= 'b0;
+                     we_a_brams_in <= 1'b0;
+                     a_pad_in <= 'b0;
+                     en_b_brams_in <= 1'b0;
+                     addr_b_brams_in <= 'b0;
+                     we_b_brams_in <= 1'b0;
+                     en_c_bram_in <= 1'b0;
+                     we_c_bram_in <= 1'b0;
+                     addr_c_bram_in <= 'b0;
+                     pe_write_idx_in <= 'b0;
+                     c_op_in <= 2'b00;
+                     pe_start_in <= 1'b0;
+                     pe_valid_in_in <= 1'b0;
+                     pe_last_in <= 1'b0;
+                     pe_row_en <= 'b0;
+                     pe_col_en <= 'b0;
+                     pe_output_capture_en <= 1'b0;
+                     pe_output_buffer_reset <= 1'b0;
+                     mult_done <= 1'b0;
+                  end
+                else
+                  begin
+                     k_idx_in <= dec_k_idx;
+                     pe_bit_idx_in <= dec_pe_bit_idx;
+                     grp_idx_in <= dec_grp_idx;
+                     en_a_brams_in <= dec_en_a_brams;
+                     addr_a_brams_in <= dec_addr_a_brams;
+                     we_a_brams_in <= 1'b0; // Keep write enables low during execution
+                     a_pad_in <= dec_a_pad;
+                     en_b_brams_in <= dec_en_b_brams;
+                     addr_b_brams_in <= dec_addr_b_brams;
+                     we_b_brams_in <= 1'b0; // Keep write enables low during execution
+                     en_c_bram_in <= dec_en_c_bram;
+                     we_c_bram_in <= dec_we_c_bram;
+                     addr_c_bram_in <= dec_addr_c_bram;
+                     pe_write_idx_in <= dec_pe_write_idx;
+                     c_op_in <= dec_c_op;
+                     pe_start_in <= dec_pe_start;
+                     pe_valid_in_in <= dec_pe_valid_in;
+                     pe_last_in <= dec_pe_last;
+                     pe_row_en <= dec_pe_row_en;
+                     pe_col_en <= dec_pe_col_en;
+                     pe_output_capture_en <= dec_pe_output_capture_en;
+                     pe_output_buffer_reset <= dec_pe_output_buffer_reset;
+                     mult_done <= dec_mult_done;
+                  end
+             end
+        end
+      else
+        begin : combinational_outputs_gen
+           always @(*)
+             begin
+                k_idx_in = dec_k_idx;
+                pe_bit_idx_in = dec_pe_bit_idx;
+                grp_idx_in = dec_grp_idx;
+                en_a_brams_in = dec_en_a_brams;
+                addr_a_brams_in = dec_addr_a_brams;
+                we_a_brams_in = 1'b0; // Keep write enables low during execution
+                a_pad_in = dec_a_pad;
+                en_b_brams_in = dec_en_b_brams;
+                addr_b_brams_in = dec_addr_b_brams;
+                we_b_brams_in = 1'b0; // Keep write enables low during execution
+                en_c_bram_in = dec_en_c_bram;
+                we_c_bram_in = dec_we_c_bram;
+                addr_c_bram_in = dec_addr_c_bram;
+                pe_write_idx_in = dec_pe_write_idx;
+                c_op_in = dec_c_op;
+                pe_start_in = dec_pe_start;
+                pe_valid_in_in = dec_pe_valid_in;
+                pe_last_in = dec_pe_last;
+                pe_row_en = dec_pe_row_en;
+                pe_col_en = dec_pe_col_en;
+                pe_output_capture_en = dec_pe_output_capture_en;
+                pe_output_buffer_reset = dec_pe_output_buffer_reset;
+                mult_done = dec_mult_done;
+             end
+        end
+   endgenerate
+
+   // synthesis translate_off
+   // Debug check: every PE must report output_valid on the cycle the latency
+   // schedule leaves WAIT_PE_DONE. A mismatch means PE_PIPE_DEPTH is wrong.
+   always @(posedge clk) begin
+      if (rst_n && current_state == WAIT_PE_DONE && drain_cnt == PE_ACC_LATENCY - 1 &&
+          pe_outputs_valid_out !== {(PE_ROWS * PE_COLS){1'b1}}) begin
+         $display("@%0t: controller: PE outputs not valid at scheduled capture (valid = %b)", $time, pe_outputs_valid_out);
       end
    end
+   // synthesis translate_on
 
 endmodule
@@ -2,8 +2,10 @@
 // Description: Datapath for matrix multiplication using BRAMs and a 2D array
 //              of INDEPENDENT PEs. Each PE computes one element of C.
 //              Updated to use the corrected 'pe_no_fifo' module with output_valid.
-//              Uses ONLY Port A for A and B BRAMs (for both loading and execution).
-//              Port B of A/B BRAMs is unused.
+//              Port A of A/B BRAMs is used for loading and execution.
+//              Port B of A/B BRAMs reads the second K slice (K_SPLIT), reads the
+//              stored value for pre-add loads (STRASSEN) or takes loader writes
+//              (STREAM_K, LOAD_RATIO); it is unused otherwise.
 //              Port A of C BRAM is for writing results (from PE buffer).
 //              Port B of C BRAM is for external reading.
 //              **UPDATED A/B BRAM ADDRESS FORMAT: {bank_index, address_within_bank}**
@@ -16,11 +18,71 @@
 // - Uses a 2D array of PE_ROWS x PE_COLS PEs.
 // - **Each PE at (pr, pc) computes C[pr][pc] independently.**
 // - **Requires 'pe_no_fifo' module to have ports: clk, clr_n, start, valid_in, last, a, b, c, output_valid.**
-// - PE pipeline latency is accounted for externally by the controller.
+// - PE pipeline latency (PE_MUL_STAGES + 2 + PE_CSA_ACC) is accounted for externally by the controller.
+// - A/B BRAM read latency (1 + BRAM_OUT_REG) is covered by the controller's prefetch
+//   distance; k_idx_in always tags the step whose data is on the BRAM outputs.
+// - PE controls (start/valid_in/last) and A/B operands reach the PEs through
+//   bcast_tree register trees of BCAST_DEPTH levels; controls and operands see
+//   the same delay, which the controller adds to its drain schedule.
+// - With PE_CLOCK_GATING, the controller's row/column enables freeze PEs outside
+//   the job shape and the whole array outside ACCUMULATE..CAPTURE_OUTPUT.
+// - With SMALL_MATRIX, loads to the A/B bank addresses fill flop register files
+//   with the same bank/address layout; PE operands are read from them
+//   combinationally at k_idx_in, and dout_c returns PE result r*PE_COLS+c
+//   (the C BRAM address the writeback would have used) one cycle after read_en_c.
+// - With K_SPLIT = 2, a second PE plane accumulates k = K_STEPS..K-1 while the
+//   first accumulates k = 0..K_STEPS-1 (K_STEPS = ceil(K/2), k_idx_in counts
+//   0..K_STEPS-1). The planes' results are summed in KSPLIT_LATENCY register
+//   stages; the controller adds that to its drain schedule.
+// - With GEMV, PE (pr, pc) is lane pr*PE_COLS + pc: it gets its own A row
+//   (A_BRAM[lane % N_BANKS]) and x[k] from B_BRAM[0], and the writeback covers
+//   N_RESULTS = min(M, PE_ROWS*PE_COLS) elements, y[lane] at C address lane.
+// - With PE_MUL_BOOTH, each A row operand is Booth-recoded once (booth_encoder)
+//   before distribution; the PEs receive the digits and only select/reduce.
+// - With PE_BIT_SERIAL, each B column source is reduced to bit pe_bit_idx_in
+//   before distribution and the PEs are pe_bitserial (no multiplier). The
+//   controller repeats the K steps once per bit plane, MSB first; a PE doubles
+//   its accumulator on every k_idx_in == 0 step (the 'shift' control).
+// - With STREAM_K, a loader writes k-slices through Port B of the A/B banks
+//   while the job runs; the controller only reads slices the loader has
+//   marked valid (see controller STREAM_K_SLOTS).
+// - With PE_DOUBLE_PUMP, PE columns pc and pc+1 (pc even) share one
+//   pe_double_pump whose multiplier runs on clk2x, serving column pc in the
+//   first half of each clk cycle and column pc+1 in the second. clk2x must be
+//   edge-aligned with clk; everything outside the PEs stays on clk.
+// - With PART_ROWS x PART_COLS > 1 and part_en_in high, the array is split into
+//   that grid of regions of PART_R_SIZE x PART_C_SIZE PEs, each computing its
+//   own job g = region_row*PART_COLS + region_col (batch of same-shape GEMMs):
+//   row i of job g's A is in A_BRAM[g*PART_R_SIZE + i] at address k, column j
+//   of its B in B_BRAM[g*PART_C_SIZE + j] at address k, and C[i][j] of job g is
+//   written to C address g*PART_R_SIZE*PART_C_SIZE + i*PART_C_SIZE + j.
+//   The jobs share the K schedule. part_en_in low uses the whole array.
+// - With STRASSEN, operands and results are two's complement and both the A/B
+//   load path and the C writeback are read-modify-write: a load or C write with
+//   op 2 (add) or 3 (subtract) combines with the stored value, read through
+//   Port B, and is written one cycle later. The host pre-adds Strassen operand
+//   blocks into the banks (e.g. A11 then +A22) and the controller post-adds
+//   each product into the C blocks it contributes to (C holds four M x N blocks).
+//   Pre-added operands are stored at DATA_WIDTH, so Strassen operands must lie in
+//   [-2^(DATA_WIDTH-2), 2^(DATA_WIDTH-2) - 1] for every sum or difference to fit.
+// - With CONV, the controller walks an input feature map stored in every A bank
+//   (im2col addressing, see controller) and flags reads in the padding ring on
+//   a_pad_in; the flag follows the read through the BRAM latency and zeroes the
+//   bank's operand.
+// - With SKEW, A/B elements are stored diagonally across the banks (see
+//   controller) and the operand of PE row/column p in step k_idx_in comes from
+//   bank (p + k_idx_in) % N_BANKS, so a rotation replaces the fixed bank wiring.
+// - With LOAD_RATIO > 1, Port B of every A/B bank is LOAD_RATIO words wide and
+//   takes all host loads (ld_* inputs, before or, with STREAM_K, during the job);
+//   Port A stays one word wide for the compute reads.
+// - With ROW_GROUPS > 1 (N_BANKS < M or N), bank b feeds PE rows b, b + N_BANKS, ...
+//   The controller reads one row group per cycle (grp_idx_in); the operands of
+//   the earlier groups are held in a_stage/b_stage and the PE step is issued
+//   with the last group, which comes straight from the BRAM outputs.
 //
 // Partitioning Details:
 // - A (M x K) row-wise into N_BANKS: A[i][k] is in A_BRAM[i % N_BANKS] at address (i / N_BANKS) * K + k
-// - B (K x N) column-wise into N_BANKS: B[k][j] is in B_BRAM[j % N_BANKS] at address k * (N / N_BANKS) + j / N_BANKS
+// - B (K x N) column-wise into N_BANKS: B[k][j] is in B_BRAM[j % N_BANKS] at address k * B_GROUPS + j / N_BANKS
 //----------------------------------------------------------------------------
 
 `include "bram.v"
@@ -28,6 +90,13 @@
 `include "multiplier_carrysave.v"
 `include "full_adder.v"
 `include "multiplier_adder.v"
+`include "bcast_tree.v"
+`include "carry_save_adder.v"
+`include "prefix_adder.v"
+`include "booth_encoder.v"
+`include "booth_multiplier.v"
+`include "pe_bitserial.v"
+`include "pe_double_pump.v"
 
 module datapath
   #(
@@ -40,34 +109,127 @@ module datapath
     // Parameters for the 2D PE Array dimensions
     // For independent PEs computing C[pr][pc] in PE(pr,pc)
     parameter PE_ROWS = M,     // Number of PE rows = M
-    parameter PE_COLS = N      // Number of PE columns = N
+    parameter PE_COLS = N,     // Number of PE columns = N
+
+    // PE pipeline configuration
+    parameter PE_MUL_STAGES = 1, // Register stages after each PE multiplier (PE latency = PE_MUL_STAGES + 2 + PE_CSA_ACC)
+    parameter PE_CSA_ACC = 0,    // 1: carry-save accumulation in the PEs, single final carry-propagate add
+    parameter PE_MUL_FINAL_ADDER = 0, // PE multiplier final adder: 0 ripple, 1 Kogge-Stone, 2 Brent-Kung, 3 Han-Carlson
+    parameter PE_MUL_BOOTH = 0,  // 1: radix-4 Booth PEs, A recoded once per PE row
+    parameter DATA_RESET = 1,    // 0: pure data registers (PE pipeline, operand trees, output buffer)
+                                 //    have no clr_n; valid/control registers keep it
+
+    // 1: PEs and operand trees are clock-enabled per row/column by the controller
+    parameter PE_CLOCK_GATING = 0,
+
+    // 1: small-matrix mode. A/B live in flop register files read directly by the
+    //    PEs (no prefetch) and dout_c reads the PE accumulators (no C BRAM writeback)
+    parameter SMALL_MATRIX = 0,
+
+    // K-split reduction: 2 = each C element is computed by two PEs, one per half
+    //    of K (second half read through the A/B BRAMs' Port B), and their partial
+    //    sums are added in one pipelined stage before capture. 1 = off.
+    parameter K_SPLIT = 1,
+
+    // 1: bit-serial PEs (pe_bitserial): one B bit per step, bit planes sequenced by
+    //    the controller (PE latency 2; no CSA_ACC/Booth/K_SPLIT/GEMV)
+    parameter PE_BIT_SERIAL = 0,
+
+    // 1: double-pumped PEs (pe_double_pump): each multiplier serves two adjacent PE
+    //    columns at clk2x (PE_COLS even, PE latency 3; no CSA_ACC/Booth/K_SPLIT/STRASSEN)
+    parameter PE_DOUBLE_PUMP = 0,
+
+    // 1: streaming K. The A/B banks take loader writes on Port B (ld_* inputs)
+    //    while the controller reads Port A, so k-slices can arrive during the job
+    //    (no K_SPLIT/STRASSEN, which also use Port B)
+    parameter STREAM_K = 0,
+
+    // 1: convolution mode, padding reads flagged on a_pad_in return 0 (see controller CONV)
+    parameter CONV = 0,
+    parameter CONV_IFM_DEPTH = 0, // A bank words added for the input feature map (Must match controller)
+
+    // 1: skewed A/B storage, PE row/column p of step k_idx_in reads bank
+    //    (p + k_idx_in) % N_BANKS (see controller SKEW; no SMALL_MATRIX/K_SPLIT/GEMV/partitioning)
+    parameter SKEW = 0,
+
+    // A/B words per load access (power of 2): Port B of the A/B banks becomes a
+    //    LOAD_RATIO-word write port for the ld_* loads (aligned to LOAD_RATIO words;
+    //    no K_SPLIT, STRASSEN or SMALL_MATRIX, which read or load through Port A/B)
+    parameter LOAD_RATIO = 1,
+
+    // Row groups per K step (see controller ROW_GROUPS; Must match controller)
+    parameter ROW_GROUPS = ((M > N ? M : N) + N_BANKS - 1) / N_BANKS,
+
+    // Spatial partitioning: grid of independent regions available when part_en_in
+    //    is high (PE_ROWS/PE_COLS must be multiples; needs N_BANKS >= PE_ROWS*PART_COLS
+    //    and >= PE_COLS*PART_ROWS; plain operands, no K_SPLIT/GEMV/SMALL_MATRIX)
+    parameter PART_ROWS = 1,
+    parameter PART_COLS = 1,
+
+    // 1: Strassen/Winograd block mode: signed PEs, add/subtract loads into the A/B
+    //    banks (pre-add) and add/subtract writebacks into four C blocks (post-add).
+    //    Uses Port B of every BRAM (no K_SPLIT, BRAM_OUT_REG, SMALL_MATRIX); signed PEs are
+    //    the pe_no_fifo array multiplier (no CSA_ACC, MUL_BOOTH or bit-serial)
+    parameter STRASSEN = 0,
+
+    // 1: matrix-vector mode. Every PE is an independent dot-product lane
+    //    (lane l = pr*PE_COLS + pc computes y[l] = A[l][:] . x) and x is broadcast
+    //    from B bank 0 (x[k] at address k). Each lane reads its own A bank, so
+    //    M <= N_BANKS; only M results are written back. Not combined with K_SPLIT.
+    parameter GEMV = 0,
+
+    // A/B BRAM output pipeline register (read latency 1 + BRAM_OUT_REG, see controller)
+    parameter BRAM_OUT_REG = 0,
+
+    // Broadcast distribution of PE controls and operands (see bcast_tree)
+    parameter BCAST_DEPTH = 0,   // Register levels between controller/BRAMs and PEs (0 = direct wires)
+    parameter BCAST_FANOUT = 4   // Loads driven by each distribution register
     )
    (
     input wire                                                                                         clk,                        // Clock signal
+    input wire                                                                                         clk2x,                      // 2x clock, edge-aligned with clk (used when PE_DOUBLE_PUMP)
     input wire                                                                                         clr_n,                      // Asynchronous active-low reset
 
     // Control Inputs for A and B BRAMs (Port A - Shared for Load/Execution)
     input wire                                                                                         en_a_brams_in,              // Enable for A banks (Port A)
-    input wire [N_BANKS * ($clog2(N_BANKS) + ((M/N_BANKS * K > 0) ? $clog2(M/N_BANKS * K) : 1)) - 1:0] addr_a_brams_in,            // Address for A banks (Port A) - {bank_idx, addr_in_bank}
+    input wire [N_BANKS * ($clog2(N_BANKS) + (((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K + CONV_IFM_DEPTH) : 1)) - 1:0] addr_a_brams_in,            // Address for A banks (Port A) - {bank_idx, addr_in_bank}
     input wire                                                                                         we_a_brams_in,              // Write enable for A banks (Port A)
     input wire [N_BANKS * DATA_WIDTH - 1:0]                                                            din_a_brams_in,             // Data input for writing to A banks (Port A)
+    input wire [N_BANKS-1:0]                                                                           a_pad_in,                   // CONV: per A bank, the read returns 0 (padding)
 
     input wire                                                                                         en_b_brams_in,              // Enable for B banks (Port A)
-    input wire [N_BANKS * ($clog2(N_BANKS) + ((K * N/N_BANKS > 0) ? $clog2(K * N/N_BANKS) : 1)) - 1:0] addr_b_brams_in,            // Address for B banks (Port A) - {bank_idx, addr_in_bank}
+    input wire [N_BANKS * ($clog2(N_BANKS) + ((K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1)) - 1:0] addr_b_brams_in,            // Address for B banks (Port A) - {bank_idx, addr_in_bank}
     input wire                                                                                         we_b_brams_in,              // Write enable for B banks (Port A)
     input wire [N_BANKS * DATA_WIDTH - 1:0]                                                            din_b_brams_in,             // Data input for writing to B banks (Port A)
+    input wire [1:0]                                                                                   load_op_in,                 // STRASSEN: A/B load operation, 0/1 write, 2 add, 3 subtract
+
+    // Loader Inputs for A and B BRAMs (Port B, STREAM_K: slices written while the job runs)
+    input wire                                                                                         ld_en_a_brams_in,           // Enable for A banks (Port B)
+    input wire [N_BANKS * ($clog2(N_BANKS) + (((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K + CONV_IFM_DEPTH) : 1)) - 1:0] ld_addr_a_brams_in,         // Address for A banks (Port B) - {bank_idx, addr_in_bank}
+    input wire                                                                                         ld_we_a_brams_in,           // Write enable for A banks (Port B)
+    input wire [N_BANKS * DATA_WIDTH * LOAD_RATIO - 1:0]                                               ld_din_a_brams_in,          // Data input for writing to A banks (Port B, LOAD_RATIO words per bank)
+    input wire                                                                                         ld_en_b_brams_in,           // Enable for B banks (Port B)
+    input wire [N_BANKS * ($clog2(N_BANKS) + ((K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1)) - 1:0] ld_addr_b_brams_in,         // Address for B banks (Port B) - {bank_idx, addr_in_bank}
+    input wire                                                                                         ld_we_b_brams_in,           // Write enable for B banks (Port B)
+    input wire [N_BANKS * DATA_WIDTH * LOAD_RATIO - 1:0]                                               ld_din_b_brams_in,          // Data input for writing to B banks (Port B, LOAD_RATIO words per bank)
 
 
     // Control Inputs from Controller (Specific to Execution Flow)
     input wire [$clog2(K)-1:0]                                                                         k_idx_in,                   // Current index for accumulation (0 to K-1)
+    input wire [((DATA_WIDTH > 1) ? $clog2(DATA_WIDTH) : 1)-1:0]                                       pe_bit_idx_in,              // B bit plane of the current step (used when PE_BIT_SERIAL)
+    input wire [((ROW_GROUPS > 1) ? $clog2(ROW_GROUPS) : 1)-1:0]                                       grp_idx_in,                 // Row group on the A/B BRAM outputs (used when ROW_GROUPS > 1)
     input wire                                                                                         en_c_bram_in,               // Enable for writing to C BRAM (Port A)
     input wire                                                                                         we_c_bram_in,               // Write enable for C BRAM (Port A)
-    input wire [((M * N > 0) ? $clog2(M * N) : 1)-1:0]                                                 addr_c_bram_in,             // Address for writing to C BRAM (Port A)
+    input wire [((M * N > 0) ? $clog2(M * N * (STRASSEN ? 4 : 1)) : 1)-1:0]                            addr_c_bram_in,             // Address for writing to C BRAM (Port A)
     input wire [$clog2(PE_ROWS*PE_COLS)-1:0]                                                           pe_write_idx_in,            // Index for writing PE outputs from buffer
+    input wire [1:0]                                                                                   c_op_in,                    // STRASSEN: C write operation, 0/1 write, 2 add, 3 subtract
 
     input wire                                                                                         pe_start_in,                // Start signal for PEs
     input wire                                                                                         pe_valid_in_in,             // Valid input signal for PEs
     input wire                                                                                         pe_last_in,                 // Last input signal for PEs
+    input wire [PE_ROWS-1:0]                                                                           pe_row_en_in,               // PE row clock enables (used when PE_CLOCK_GATING)
+    input wire [PE_COLS-1:0]                                                                           pe_col_en_in,               // PE column clock enables (used when PE_CLOCK_GATING)
+    input wire                                                                                         part_en_in,                 // Run the array as PART_ROWS x PART_COLS independent regions
 
     input wire                                                                                         pe_output_capture_en,       // Enable to capture PE outputs into buffer
     input wire                                                                                         pe_output_buffer_reset,     // Reset the PE output buffer
@@ -81,33 +243,79 @@ module datapath
     // Output C BRAM Reading Interface (for external system to read the result)
     // This interface remains the same to read the final result from C BRAM.
     input wire                                                                                         read_en_c,                  // External read enable for C BRAM Port B
-    input wire [((M * N > 0) ? $clog2(M * N) : 1)-1:0]                                                 read_addr_c,                // External read address for C BRAM Port B
+    input wire [((M * N > 0) ? $clog2(M * N * (STRASSEN ? 4 : 1)) : 1)-1:0]                            read_addr_c,                // External read address for C BRAM Port B
     output wire [(DATA_WIDTH * 2 + ((K > 1) ? $clog2(K) : 1))-1:0]                                     dout_c                      // Data output from C BRAM
     );
 
    // Derived Parameters (matching datapath)
-   parameter ADDR_WIDTH_A = ($clog2(N_BANKS) + ((M/N_BANKS * K > 0) ? $clog2(M/N_BANKS * K) : 1));
-   parameter ADDR_WIDTH_B = ($clog2(N_BANKS) + ((K * N/N_BANKS > 0) ? $clog2(K * N/N_BANKS) : 1));
-   parameter ADDR_WIDTH_A_BANK = (M/N_BANKS * K > 0) ? $clog2(M/N_BANKS * K) : 1;
-   parameter ADDR_WIDTH_B_BANK = (K * N/N_BANKS > 0) ? $clog2(K * N/N_BANKS) : 1;
-   parameter ADDR_WIDTH_C = (M * N > 0) ? $clog2(M * N) : 1;
+   parameter ADDR_WIDTH_A = ($clog2(N_BANKS) + (((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K + CONV_IFM_DEPTH) : 1));
+   parameter ADDR_WIDTH_B = ($clog2(N_BANKS) + ((K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1));
+   parameter ADDR_WIDTH_A_BANK = ((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K + CONV_IFM_DEPTH) : 1;
+   parameter ADDR_WIDTH_B_BANK = (K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1;
+   parameter ADDR_WIDTH_C = (M * N > 0) ? $clog2(M * N * (STRASSEN ? 4 : 1)) : 1;
    parameter ACC_WIDTH_PE = DATA_WIDTH * 2 + ((K > 1) ? $clog2(K) : 1); // PE accumulator width must match
    parameter ADDR_WIDTH_BANK = $clog2(N_BANKS); // Width of the bank index in the new address format
+   parameter K_STEPS = (K + K_SPLIT - 1) / K_SPLIT; // Accumulation steps per K slice
+   parameter KSPLIT_LATENCY = (K_SPLIT > 1) ? 1 : 0; // Partial-sum adder stages
+   parameter N_RESULTS = (GEMV && M < PE_ROWS*PE_COLS) ? M : PE_ROWS*PE_COLS; // C elements written back
+   parameter PE_A_WIDTH = PE_MUL_BOOTH ? 3 * (DATA_WIDTH/2 + 1) : DATA_WIDTH; // Width of the distributed A operand
+   parameter PE_B_WIDTH = PE_BIT_SERIAL ? 1 : DATA_WIDTH; // Width of the distributed B operand (word or bit plane)
+   parameter PART_R_SIZE = PE_ROWS / PART_ROWS; // PE rows per region
+   parameter PART_C_SIZE = PE_COLS / PART_COLS; // PE columns per region
+   parameter A_GROUPS = (M + N_BANKS - 1) / N_BANKS; // A rows per bank
+   parameter B_GROUPS = (N + N_BANKS - 1) / N_BANKS; // B columns per bank
+   parameter LOAD_SHIFT = $clog2(LOAD_RATIO); // Port B address bits below a load access
 
    // Internal Signals
    integer   i, j; // Loop variable
    integer   pr_idx, pc_idx; // Loop variables for PE array
+   integer   lane_idx; // Loop variable for GEMV lanes
+   integer   part_idx; // Loop variable for the partitioned-mode sources
+   integer   part_job, part_bank; // Job and bank of a partitioned-mode source
    integer   a_bank_idx, b_bank_idx;
+   integer   stg_idx; // Loop variable for the ROW_GROUPS staging registers
 
    // Internal BRAM Interface Signals (These are outputs from BRAMs)
    wire [DATA_WIDTH-1:0] dout_a_brams[N_BANKS-1:0]; // Data read from A BRAM banks (Port A)
    wire [DATA_WIDTH-1:0] dout_b_brams[N_BANKS-1:0]; // Data read from B BRAM banks (Port A)
 
+   // Operand sources before distribution (one per PE row for A, one per PE column for B)
+   reg [DATA_WIDTH-1:0]  a_row_src[PE_ROWS-1:0]; // A operand for PE row pr
+   reg [DATA_WIDTH-1:0]  b_col_src[PE_COLS-1:0]; // B operand for PE column pc
+   reg [DATA_WIDTH-1:0]  a_lane_src[PE_ROWS*PE_COLS-1:0]; // GEMV: A operand for lane pr*PE_COLS+pc
+   reg [DATA_WIDTH-1:0]  a_part_src[PE_ROWS*PART_COLS-1:0]; // Partitioned: A operand for PE row pr in region column rc (pr*PART_COLS+rc)
+   reg [DATA_WIDTH-1:0]  b_part_src[PART_ROWS*PE_COLS-1:0]; // Partitioned: B operand for PE column pc in region row rr (rr*PE_COLS+pc)
+
+   // ROW_GROUPS: operands of the row groups read before the last one of a K step
+   reg [DATA_WIDTH-1:0]  a_stage[PE_ROWS-1:0]; // A operand of PE row pr (group pr / N_BANKS)
+   reg [DATA_WIDTH-1:0]  b_stage[PE_COLS-1:0]; // B operand of PE column pc (group pc / N_BANKS)
+
+   // K_SPLIT: second K slice, read through Port B of the A/B BRAMs
+   wire [DATA_WIDTH-1:0] dout_a_brams_k1[N_BANKS-1:0]; // Data read from A BRAM banks (Port B)
+   wire [DATA_WIDTH-1:0] dout_b_brams_k1[N_BANKS-1:0]; // Data read from B BRAM banks (Port B)
+   wire [ADDR_WIDTH_A-1:0] addr_a_k1_sliced[N_BANKS-1:0]; // Port A address advanced by K_STEPS
+   wire [ADDR_WIDTH_B-1:0] addr_b_k1_sliced[N_BANKS-1:0]; // Port A address advanced by K_STEPS rows of B
+   reg [DATA_WIDTH-1:0]  a_row_src_k1[PE_ROWS-1:0]; // A operand for PE row pr, second slice
+   reg [DATA_WIDTH-1:0]  b_col_src_k1[PE_COLS-1:0]; // B operand for PE column pc, second slice
+
+   // Distributed PE controls (flattened {start, valid_in, last} per PE)
+   wire [PE_ROWS*PE_COLS*3-1:0] pe_ctrl_dist;
+   wire [PE_ROWS*PE_COLS-1:0]   pe_shift_dist; // PE_BIT_SERIAL: first step of a bit plane
+
+   // Row/column clock enables (all ones without PE_CLOCK_GATING) and their
+   // per-PE copies after distribution; a PE runs when both are high
+   wire [PE_ROWS-1:0]    row_en = PE_CLOCK_GATING ? pe_row_en_in : {PE_ROWS{1'b1}};
+   wire [PE_COLS-1:0]    col_en = PE_CLOCK_GATING ? pe_col_en_in : {PE_COLS{1'b1}};
+   wire                  pe_row_en_dist[PE_ROWS-1:0][PE_COLS-1:0];
+   wire                  pe_col_en_dist[PE_ROWS-1:0][PE_COLS-1:0];
+
    // Internal PE Array Interface Signals (2D arrays for inputs and outputs)
-   reg [DATA_WIDTH-1:0]  pe_a_in[PE_ROWS-1:0][PE_COLS-1:0]; // Input 'a' to PE array
-   reg [DATA_WIDTH-1:0]  pe_b_in[PE_ROWS-1:0][PE_COLS-1:0]; // Input 'b' to PE array
+   wire [PE_A_WIDTH-1:0] pe_a_in[PE_ROWS-1:0][PE_COLS-1:0]; // Input 'a' to PE array (data or Booth digits)
+   wire [PE_B_WIDTH-1:0] pe_b_in[PE_ROWS-1:0][PE_COLS-1:0]; // Input 'b' to PE array (data or bit plane)
    wire [ACC_WIDTH_PE-1:0] pe_c_out[PE_ROWS-1:0][PE_COLS-1:0]; // Output 'c' from PE array
    wire                    pe_output_valid[PE_ROWS-1:0][PE_COLS-1:0]; // Output 'output_valid' from PE array
+   wire [PE_A_WIDTH-1:0]   pe_a_in_k1[PE_ROWS-1:0][PE_COLS-1:0]; // Input 'a' to the second-slice PEs
+   wire [DATA_WIDTH-1:0]   pe_b_in_k1[PE_ROWS-1:0][PE_COLS-1:0]; // Input 'b' to the second-slice PEs
 
 
    // Internal Buffer for PE Outputs before Writing to C BRAM (Flattened 1D buffer)
@@ -127,9 +335,19 @@ module datapath
    // Internal wires to slice the flattened data ports from the top
    wire [ADDR_WIDTH_A-1:0]      addr_a_bram_sliced [N_BANKS-1:0];
    wire [ADDR_WIDTH_B-1:0]      addr_b_bram_sliced [N_BANKS-1:0];
+   wire [ADDR_WIDTH_A-1:0]      ld_addr_a_bram_sliced [N_BANKS-1:0]; // STREAM_K loader (Port B)
+   wire [ADDR_WIDTH_B-1:0]      ld_addr_b_bram_sliced [N_BANKS-1:0];
 
    // Internal wire for C BRAM inputs (from the PE output buffer)
    wire [ACC_WIDTH_PE-1:0]      din_c_bram; // Data input to C BRAM
+   wire [ACC_WIDTH_PE-1:0]      dout_c_bram; // External read data from C BRAM (Port B)
+
+   // Small-matrix register files (SMALL_MATRIX only): bank-major, same layout as the BRAM banks
+   parameter RF_DEPTH_A = 1 << ADDR_WIDTH_A_BANK; // Entries per A bank
+   parameter RF_DEPTH_B = 1 << ADDR_WIDTH_B_BANK; // Entries per B bank
+   reg [DATA_WIDTH-1:0]         a_rf [N_BANKS*RF_DEPTH_A-1:0];
+   reg [DATA_WIDTH-1:0]         b_rf [N_BANKS*RF_DEPTH_B-1:0];
+   reg [ACC_WIDTH_PE-1:0]       dout_c_rf; // PE result read register
 
    // Connect flattened data ports to sliced internal wires
    genvar                       j_gen;
@@ -147,6 +365,11 @@ module datapath
            // Port A of BRAMs (driven by top/controller)
            assign addr_a_bram_sliced[j_gen] = addr_a_brams_in[(j_gen * ADDR_WIDTH_A) + ADDR_WIDTH_A - 1 -: ADDR_WIDTH_A];
            assign addr_b_bram_sliced[j_gen] = addr_b_brams_in[(j_gen * ADDR_WIDTH_B) + ADDR_WIDTH_B - 1 -: ADDR_WIDTH_B];
+           assign ld_addr_a_bram_sliced[j_gen] = ld_addr_a_brams_in[(j_gen * ADDR_WIDTH_A) + ADDR_WIDTH_A - 1 -: ADDR_WIDTH_A];
+           assign ld_addr_b_bram_sliced[j_gen] = ld_addr_b_brams_in[(j_gen * ADDR_WIDTH_B) + ADDR_WIDTH_B - 1 -: ADDR_WIDTH_B];
+           // Second K slice: same step, K_STEPS further along K
+           assign addr_a_k1_sliced[j_gen] = addr_a_bram_sliced[j_gen] + K_STEPS;
+           assign addr_b_k1_sliced[j_gen] = addr_b_bram_sliced[j_gen] + K_STEPS * B_GROUPS;
         end
    endgenerate
    generate
@@ -180,54 +403,256 @@ module datapath
    //--------------------------------------------------------------------------
 
    // Matrix A BRAMs (N_BANKS instances) - Row-wise Interleaved
-   // Port A is used for both loading and execution. Port B is unused.
+   // Port A is used for both loading and execution. Port B reads the second K slice (K_SPLIT)
+   // or takes the loads (STREAM_K, LOAD_RATIO).
    genvar gi_a;
    generate
       for (gi_a = 0; gi_a < N_BANKS; gi_a = gi_a + 1)
         begin : a_bram_gen
-           bram #(.ADDR_WIDTH (ADDR_WIDTH_A), .DATA_WIDTH (DATA_WIDTH))
+           wire                             a_sel = (addr_a_bank_idx[gi_a] == gi_a); // This bank is addressed
+           wire                             pa_en, pa_we; // Port A controls after the load pre-add stage
+           wire [ADDR_WIDTH_A-1:0]          pa_addr;
+           wire [DATA_WIDTH-1:0]            pa_din;
+           wire                             pb_en, pb_we;
+           wire [ADDR_WIDTH_A-1:0]          pb_addr;
+           wire [DATA_WIDTH*LOAD_RATIO-1:0] pb_din;
+           wire [DATA_WIDTH*LOAD_RATIO-1:0] pb_dout; // Port B read data (one word unless LOAD_RATIO)
+           wire [DATA_WIDTH-1:0]            pa_dout; // Port A read data before the padding mask
+
+           if (STRASSEN)
+             begin : a_preadd_gen
+                // Load writes read the stored value through Port B and are written
+                // one cycle later, combined with it per load_op_in
+                reg                    pend_we;   // A load write is pending
+                reg [ADDR_WIDTH_A-1:0] pend_addr;
+                reg [DATA_WIDTH-1:0]   pend_din;
+                reg [1:0]              pend_op;
+                reg                    fwd;       // Pending address was being written when it was read
+                reg [DATA_WIDTH-1:0]   fwd_val;
+                wire [DATA_WIDTH-1:0]  old_val = fwd ? fwd_val : dout_a_brams_k1[gi_a];
+                wire [DATA_WIDTH-1:0]  wr_val = (pend_op == 2'b10) ? old_val + pend_din :
+                                                (pend_op == 2'b11) ? old_val - pend_din : pend_din;
+
+                always @(posedge clk or negedge clr_n)
+                  begin
+                     if (!clr_n)
+                       begin
+                          pend_we <= 1'b0;
+                          fwd <= 1'b0;
+                       end
+                     else
+                       begin
+                          pend_we <= en_a_brams_in && we_a_brams_in && a_sel;
+                          fwd <= pend_we && (pend_addr == addr_a_bram_sliced[gi_a]);
+                       end
+                  end
+
+                // Data fields are only used while pend_we/fwd are set
+                always @(posedge clk)
+                  begin
+                     if (en_a_brams_in && we_a_brams_in && a_sel)
+                       begin
+                          pend_addr <= addr_a_bram_sliced[gi_a];
+                          pend_din <= din_a_bram_sliced[gi_a];
+                          pend_op <= load_op_in;
+                       end
+                     fwd_val <= wr_val;
+                  end
+
+                assign pa_en = pend_we || (en_a_brams_in && !we_a_brams_in && a_sel);
+                assign pa_we = pend_we;
+                assign pa_addr = pend_we ? pend_addr : addr_a_bram_sliced[gi_a];
+                assign pa_din = wr_val;
+                assign pb_en = en_a_brams_in && we_a_brams_in && a_sel;
+                assign pb_we = 1'b0;
+                assign pb_addr = addr_a_bram_sliced[gi_a];
+                assign pb_din = 'b0;
+             end
+           else if (STREAM_K || LOAD_RATIO > 1)
+             begin : a_stream_gen
+                // Port A: controller reads (or loads before the job); Port B: loader
+                // writes while the job runs (LOAD_RATIO: every load, LOAD_RATIO words wide)
+                assign pa_en = en_a_brams_in && a_sel;
+                assign pa_we = we_a_brams_in && a_sel;
+                assign pa_addr = addr_a_bram_sliced[gi_a];
+                assign pa_din = din_a_bram_sliced[gi_a];
+                assign pb_en = ld_en_a_brams_in && (ld_addr_a_bram_sliced[gi_a][ADDR_WIDTH_A-1 -: ADDR_WIDTH_BANK] == gi_a);
+                assign pb_we = ld_we_a_brams_in;
+                assign pb_addr = ld_addr_a_bram_sliced[gi_a];
+                assign pb_din = ld_din_a_brams_in[gi_a * DATA_WIDTH * LOAD_RATIO +: DATA_WIDTH * LOAD_RATIO];
+             end
+           else
+             begin : a_direct_gen
+                assign pa_en = en_a_brams_in && a_sel; // Enable only for the selected bank
+                assign pa_we = we_a_brams_in && a_sel; // Write enable only for the selected bank
+                assign pa_addr = addr_a_bram_sliced[gi_a];
+                assign pa_din = din_a_bram_sliced[gi_a];
+                assign pb_en = (K_SPLIT > 1) && en_a_brams_in && a_sel;
+                assign pb_we = 1'b0;
+                assign pb_addr = addr_a_k1_sliced[gi_a];
+                assign pb_din = 'b0;
+             end
+
+           bram #(.ADDR_WIDTH (ADDR_WIDTH_A), .DATA_WIDTH (DATA_WIDTH), .OUT_REG (BRAM_OUT_REG), .B_RATIO (LOAD_RATIO))
            a_bram_inst (
                         .clk    (clk),
                         // **Connect Port A based on extracted bank index**
-                        .en_a   (en_a_brams_in && (addr_a_bank_idx[gi_a] == gi_a)), // Enable only for the selected bank
-                        .we_a   (we_a_brams_in && (addr_a_bank_idx[gi_a] == gi_a)), // Write enable only for the selected bank
-                        .addr_a (addr_a_bram_sliced[gi_a]), // Address within the selected bank
-                        .din_a  (din_a_bram_sliced[gi_a]), // Data input for the selected bank
-                        .dout_a (dout_a_brams[gi_a]), // Port A: Read data out (to PE array)
-
-                        // Port B: Unused
-                        .en_b   (1'b0),
-                        .we_b   (1'b0),
-                        .addr_b (0),
-                        .din_b  (0),
-                        .dout_b ()
+                        .en_a   (pa_en),
+                        .we_a   (pa_we),
+                        .addr_a (pa_addr), // Address within the selected bank
+                        .din_a  (pa_din), // Data input for the selected bank
+                        .dout_a (pa_dout), // Port A: Read data out (to PE array)
+
+                        // Port B: second K slice reads (K_SPLIT), pre-add reads (STRASSEN),
+                        // loader writes (STREAM_K, LOAD_RATIO), otherwise unused
+                        .en_b   (pb_en),
+                        .we_b   (pb_we),
+                        .addr_b (pb_addr[ADDR_WIDTH_A-1:LOAD_SHIFT]),
+                        .din_b  (pb_din),
+                        .dout_b (pb_dout)
                         );
+
+           assign dout_a_brams_k1[gi_a] = pb_dout[DATA_WIDTH-1:0];
+
+           if (CONV)
+             begin : a_pad_gen
+                // The pad flag is captured with the read (and held with the
+                // BRAM output while the port is idle), plus the output register
+                reg pad_q;
+                reg pad_q2;
+
+                always @(posedge clk or negedge clr_n)
+                  begin
+                     if (!clr_n)
+                       begin
+                          pad_q <= 1'b0;
+                          pad_q2 <= 1'b0;
+                       end
+                     else
+                       begin
+                          if (pa_en && !pa_we)
+                            pad_q <= a_pad_in[gi_a];
+                          pad_q2 <= pad_q;
+                       end
+                  end
+
+                assign dout_a_brams[gi_a] = (BRAM_OUT_REG ? pad_q2 : pad_q) ? {DATA_WIDTH{1'b0}} : pa_dout;
+             end
+           else
+             begin : a_nopad_gen
+                assign dout_a_brams[gi_a] = pa_dout;
+             end
         end
    endgenerate
 
    // Matrix B BRAMs (N_BANKS instances - Partitioned Column-wise)
-   // Port A is used for both loading and execution. Port B is unused.
+   // Port A is used for both loading and execution. Port B reads the second K slice (K_SPLIT)
+   // or takes the loads (STREAM_K, LOAD_RATIO).
    genvar gi_b;
    generate
       for (gi_b = 0; gi_b < N_BANKS; gi_b = gi_b + 1)
         begin : b_bram_gen
-           bram #(.ADDR_WIDTH (ADDR_WIDTH_B), .DATA_WIDTH (DATA_WIDTH))
+           wire                             b_sel = (addr_b_bank_idx[gi_b] == gi_b); // This bank is addressed
+           wire                             pa_en, pa_we; // Port A controls after the load pre-add stage
+           wire [ADDR_WIDTH_B-1:0]          pa_addr;
+           wire [DATA_WIDTH-1:0]            pa_din;
+           wire                             pb_en, pb_we;
+           wire [ADDR_WIDTH_B-1:0]          pb_addr;
+           wire [DATA_WIDTH*LOAD_RATIO-1:0] pb_din;
+           wire [DATA_WIDTH*LOAD_RATIO-1:0] pb_dout; // Port B read data (one word unless LOAD_RATIO)
+
+           if (STRASSEN)
+             begin : b_preadd_gen
+                // Same read-modify-write load path as a_preadd_gen
+                reg                    pend_we;
+                reg [ADDR_WIDTH_B-1:0] pend_addr;
+                reg [DATA_WIDTH-1:0]   pend_din;
+                reg [1:0]              pend_op;
+                reg                    fwd;
+                reg [DATA_WIDTH-1:0]   fwd_val;
+                wire [DATA_WIDTH-1:0]  old_val = fwd ? fwd_val : dout_b_brams_k1[gi_b];
+                wire [DATA_WIDTH-1:0]  wr_val = (pend_op == 2'b10) ? old_val + pend_din :
+                                                (pend_op == 2'b11) ? old_val - pend_din : pend_din;
+
+                always @(posedge clk or negedge clr_n)
+                  begin
+                     if (!clr_n)
+                       begin
+                          pend_we <= 1'b0;
+                          fwd <= 1'b0;
+                       end
+                     else
+                       begin
+                          pend_we <= en_b_brams_in && we_b_brams_in && b_sel;
+                          fwd <= pend_we && (pend_addr == addr_b_bram_sliced[gi_b]);
+                       end
+                  end
+
+                always @(posedge clk)
+                  begin
+                     if (en_b_brams_in && we_b_brams_in && b_sel)
+                       begin
+                          pend_addr <= addr_b_bram_sliced[gi_b];
+                          pend_din <= din_b_bram_sliced[gi_b];
+                          pend_op <= load_op_in;
+                       end
+                     fwd_val <= wr_val;
+                  end
+
+                assign pa_en = pend_we || (en_b_brams_in && !we_b_brams_in && b_sel);
+                assign pa_we = pend_we;
+                assign pa_addr = pend_we ? pend_addr : addr_b_bram_sliced[gi_b];
+                assign pa_din = wr_val;
+                assign pb_en = en_b_brams_in && we_b_brams_in && b_sel;
+                assign pb_we = 1'b0;
+                assign pb_addr = addr_b_bram_sliced[gi_b];
+                assign pb_din = 'b0;
+             end
+           else if (STREAM_K || LOAD_RATIO > 1)
+             begin : b_stream_gen
+                // Port A: controller reads (or loads before the job); Port B: loader
+                // writes while the job runs (LOAD_RATIO: every load, LOAD_RATIO words wide)
+                assign pa_en = en_b_brams_in && b_sel;
+                assign pa_we = we_b_brams_in && b_sel;
+                assign pa_addr = addr_b_bram_sliced[gi_b];
+                assign pa_din = din_b_bram_sliced[gi_b];
+                assign pb_en = ld_en_b_brams_in && (ld_addr_b_bram_sliced[gi_b][ADDR_WIDTH_B-1 -: ADDR_WIDTH_BANK] == gi_b);
+                assign pb_we = ld_we_b_brams_in;
+                assign pb_addr = ld_addr_b_bram_sliced[gi_b];
+                assign pb_din = ld_din_b_brams_in[gi_b * DATA_WIDTH * LOAD_RATIO +: DATA_WIDTH * LOAD_RATIO];
+             end
+           else
+             begin : b_direct_gen
+                assign pa_en = en_b_brams_in && b_sel; // Enable only for the selected bank
+                assign pa_we = we_b_brams_in && b_sel; // Write enable only for the selected bank
+                assign pa_addr = addr_b_bram_sliced[gi_b];
+                assign pa_din = din_b_bram_sliced[gi_b];
+                assign pb_en = (K_SPLIT > 1) && en_b_brams_in && b_sel;
+                assign pb_we = 1'b0;
+                assign pb_addr = addr_b_k1_sliced[gi_b];
+                assign pb_din = 'b0;
+             end
+
+           bram #(.ADDR_WIDTH (ADDR_WIDTH_B), .DATA_WIDTH (DATA_WIDTH), .OUT_REG (BRAM_OUT_REG), .B_RATIO (LOAD_RATIO))
            b_bram_inst (
                         .clk    (clk),
                         // **Connect Port A based on extracted bank index**
-                        .en_a   (en_b_brams_in && (addr_b_bank_idx[gi_b] == gi_b)), // Enable only for the selected bank
-                        .we_a   (we_b_brams_in && (addr_b_bank_idx[gi_b] == gi_b)), // Write enable only for the selected bank
-                        .addr_a (addr_b_bram_sliced[gi_b]), // Address within the selected bank
-                        .din_a  (din_b_bram_sliced[gi_b]), // Data input for the selected bank
+                        .en_a   (pa_en),
+                        .we_a   (pa_we),
+                        .addr_a (pa_addr), // Address within the selected bank
+                        .din_a  (pa_din), // Data input for the selected bank
                         .dout_a (dout_b_brams[gi_b]), // Port A: Read data out (to PE array)
 
-                        // Port B: Unused
-                        .en_b   (1'b0),
-                        .we_b   (1'b0),
-                        .addr_b (0),
-                        .din_b  (0),
-                        .dout_b ()
+                        // Port B: second K slice reads (K_SPLIT), pre-add reads (STRASSEN),
+                        // loader writes (STREAM_K, LOAD_RATIO), otherwise unused
+                        .en_b   (pb_en),
+                        .we_b   (pb_we),
+                        .addr_b (pb_addr[ADDR_WIDTH_B-1:LOAD_SHIFT]),
+                        .din_b  (pb_din),
+                        .dout_b (pb_dout)
                         );
+
+           assign dout_b_brams_k1[gi_b] = pb_dout[DATA_WIDTH-1:0];
         end
    endgenerate
 
@@ -235,22 +660,122 @@ module datapath
    // Matrix C BRAM
    // This BRAM stores the final M x N result.
    // Port A is for writing results (from PE buffer). Port B is for external reading.
+   wire                    c_pa_en, c_pa_we; // Port A controls after the post-add stage
+   wire [ADDR_WIDTH_C-1:0] c_pa_addr;
+   wire [ACC_WIDTH_PE-1:0] c_pa_din;
+   wire                    c_pb_en;
+   wire [ADDR_WIDTH_C-1:0] c_pb_addr;
+
+   generate
+      if (STRASSEN)
+        begin : c_postadd_gen
+           // Writebacks read the stored value through Port B and are written one
+           // cycle later, combined with it per c_op_in. The host does not read C
+           // while a job runs, so Port B is free during the writeback.
+           reg                    pend_we;
+           reg [ADDR_WIDTH_C-1:0] pend_addr;
+           reg [ACC_WIDTH_PE-1:0] pend_din;
+           reg [1:0]              pend_op;
+           wire                   c_wr = en_c_bram_in && we_c_bram_in;
+
+           always @(posedge clk or negedge clr_n)
+             begin
+                if (!clr_n)
+                  pend_we <= 1'b0;
+                else
+                  pend_we <= c_wr;
+             end
+
+           // Data fields are only used while pend_we is set
+           always @(posedge clk)
+             begin
+                if (c_wr)
+                  begin
+                     pend_addr <= addr_c_bram_in;
+                     pend_din <= din_c_bram;
+                     pend_op <= c_op_in;
+                  end
+             end
+
+           // Writeback addresses are distinct within a block and across blocks,
+           // so a read never needs the value still being written
+           assign c_pa_en = pend_we;
+           assign c_pa_we = pend_we;
+           assign c_pa_addr = pend_addr;
+           assign c_pa_din = (pend_op == 2'b10) ? dout_c_bram + pend_din :
+                             (pend_op == 2'b11) ? dout_c_bram - pend_din : pend_din;
+           assign c_pb_en = c_wr || read_en_c;
+           assign c_pb_addr = c_wr ? addr_c_bram_in : read_addr_c;
+        end
+      else
+        begin : c_direct_gen
+           assign c_pa_en = en_c_bram_in;
+           assign c_pa_we = we_c_bram_in;
+           assign c_pa_addr = addr_c_bram_in;
+           assign c_pa_din = din_c_bram;
+           assign c_pb_en = read_en_c;
+           assign c_pb_addr = read_addr_c;
+        end
+   endgenerate
+
    bram #(.ADDR_WIDTH (ADDR_WIDTH_C), .DATA_WIDTH (ACC_WIDTH_PE)) // C BRAM stores accumulated results
    c_bram_inst (
                 .clk    (clk),
-                .en_a   (en_c_bram_in), // Port A: Internal write enable    (from controller)
-                .we_a   (we_c_bram_in), // Port A: Internal write operation (from controller)
-                .addr_a (addr_c_bram_in), // Port A: Internal write address (from controller)
-                .din_a  (din_c_bram), // Port A: Internal write data in     (from PE outputs)
+                .en_a   (c_pa_en), // Port A: Internal write enable    (from controller)
+                .we_a   (c_pa_we), // Port A: Internal write operation (from controller)
+                .addr_a (c_pa_addr), // Port A: Internal write address (from controller)
+                .din_a  (c_pa_din), // Port A: Internal write data in     (from PE outputs)
                 .dout_a (), // Port A: Not used for internal write
 
-                .en_b   (read_en_c), // Port B: External read enable        (from top module)
+                .en_b   (c_pb_en), // Port B: External read enable        (from top module)
                 .we_b   (1'b0), // Port B: External read operation
-                .addr_b (read_addr_c), // Port B: External read address     (from top module)
+                .addr_b (c_pb_addr), // Port B: External read address     (from top module)
                 .din_b  (0), // Port B: Not used for external read
-                .dout_b (dout_c) // Port B: External read data out (to top module)
+                .dout_b (dout_c_bram) // Port B: External read data out (to top module)
                 );
 
+   //--------------------------------------------------------------------------
+   // Small-Matrix Register Files
+   // Written through the same Port A load interface as the A/B BRAMs. The
+   // BRAMs are still present but unread in this mode, so synthesis drops them.
+   //--------------------------------------------------------------------------
+   generate
+      if (SMALL_MATRIX)
+        begin : small_rf_gen
+           integer rf_bank; // Loop variable over banks
+
+           always @(posedge clk)
+             begin
+                for (rf_bank = 0; rf_bank < N_BANKS; rf_bank = rf_bank + 1)
+                  begin
+                     if (en_a_brams_in && we_a_brams_in && addr_a_bank_idx[rf_bank] == rf_bank)
+                       begin
+                          a_rf[rf_bank * RF_DEPTH_A + addr_a_bram_sliced[rf_bank][ADDR_WIDTH_A_BANK-1:0]] <= din_a_bram_sliced[rf_bank];
+                       end
+                     if (en_b_brams_in && we_b_brams_in && addr_b_bank_idx[rf_bank] == rf_bank)
+                       begin
+                          b_rf[rf_bank * RF_DEPTH_B + addr_b_bram_sliced[rf_bank][ADDR_WIDTH_B_BANK-1:0]] <= din_b_bram_sliced[rf_bank];
+                       end
+                  end
+             end
+
+           // Results are read straight from the PE accumulators (same timing as C BRAM Port B)
+           always @(posedge clk)
+             begin
+                if (read_en_c)
+                  begin
+                     dout_c_rf <= pe_c_out_out[read_addr_c * ACC_WIDTH_PE +: ACC_WIDTH_PE];
+                  end
+             end
+
+           assign dout_c = dout_c_rf;
+        end
+      else
+        begin : c_bram_read_gen
+           assign dout_c = dout_c_bram;
+        end
+   endgenerate
+
    //--------------------------------------------------------------------------
    // 2D Independent PE Array Instantiation
    //--------------------------------------------------------------------------
@@ -262,74 +787,571 @@ module datapath
         begin : pe_row_gen
            for (pe_pc = 0; pe_pc < PE_COLS; pe_pc = pe_pc + 1)
              begin : pe_col_gen
+                if (PE_BIT_SERIAL)
+                  begin : pe_serial_gen
+                     pe_bitserial #(.DATA_WIDTH (DATA_WIDTH), .ACC_WIDTH (ACC_WIDTH_PE), .DATA_RESET (DATA_RESET))
+                     pe_inst (
+                              .clk          (clk),
+                              .clr_n        (clr_n),
+                              .ce           (pe_row_en_dist[pe_pr][pe_pc] & pe_col_en_dist[pe_pr][pe_pc]),
+                              .start        (pe_ctrl_dist[(pe_pr * PE_COLS + pe_pc) * 3 + 2]),
+                              .valid_in     (pe_ctrl_dist[(pe_pr * PE_COLS + pe_pc) * 3 + 1]),
+                              .last         (pe_ctrl_dist[(pe_pr * PE_COLS + pe_pc) * 3 + 0]),
+                              .shift        (pe_shift_dist[pe_pr * PE_COLS + pe_pc]),
+                              .a            (pe_a_in[pe_pr][pe_pc]),
+                              .b            (pe_b_in[pe_pr][pe_pc]), // Bit pe_bit_idx_in of B
+                              .c            (pe_c_out[pe_pr][pe_pc]),
+                              .output_valid (pe_output_valid[pe_pr][pe_pc])
+                              );
+                  end
+                else if (PE_DOUBLE_PUMP)
+                  begin : pe_pump_gen
+                     // Columns pe_pc and pe_pc+1 share the multiplier of the even column;
+                     // both use that column's controls
+                     if (pe_pc % 2 == 0)
+                       begin : pe_pair_gen
+                          pe_double_pump #(.DATA_WIDTH (DATA_WIDTH), .ACC_WIDTH (ACC_WIDTH_PE),
+                                           .MUL_FINAL_ADDER (PE_MUL_FINAL_ADDER), .DATA_RESET (DATA_RESET))
+                          pe_inst (
+                                   .clk          (clk),
+                                   .clk2x        (clk2x),
+                                   .clr_n        (clr_n),
+                                   .ce           (pe_row_en_dist[pe_pr][pe_pc] & (pe_col_en_dist[pe_pr][pe_pc] | pe_col_en_dist[pe_pr][pe_pc + 1])),
+                                   .start        (pe_ctrl_dist[(pe_pr * PE_COLS + pe_pc) * 3 + 2]),
+                                   .valid_in     (pe_ctrl_dist[(pe_pr * PE_COLS + pe_pc) * 3 + 1]),
+                                   .last         (pe_ctrl_dist[(pe_pr * PE_COLS + pe_pc) * 3 + 0]),
+                                   .a0           (pe_a_in[pe_pr][pe_pc]),
+                                   .b0           (pe_b_in[pe_pr][pe_pc]),
+                                   .a1           (pe_a_in[pe_pr][pe_pc + 1]),
+                                   .b1           (pe_b_in[pe_pr][pe_pc + 1]),
+                                   .c0           (pe_c_out[pe_pr][pe_pc]),
+                                   .c1           (pe_c_out[pe_pr][pe_pc + 1]),
+                                   .output_valid (pe_output_valid[pe_pr][pe_pc])
+                                   );
+
+                          assign pe_output_valid[pe_pr][pe_pc + 1] = pe_output_valid[pe_pr][pe_pc];
+                       end
+                  end
+                else
+                  begin : pe_single_gen
+                     wire [ACC_WIDTH_PE-1:0] pe_c_part;    // PE result (first K slice when K_SPLIT)
+                     wire                    pe_valid_part;
+
+                     // Instantiate the PE module
+                     pe_no_fifo #(.DATA_WIDTH (DATA_WIDTH), .ACC_WIDTH (ACC_WIDTH_PE), .MUL_STAGES (PE_MUL_STAGES), .CSA_ACC (PE_CSA_ACC),
+                                  .MUL_FINAL_ADDER (PE_MUL_FINAL_ADDER), .MUL_BOOTH (PE_MUL_BOOTH), .DATA_RESET (DATA_RESET),
+                                  .MUL_SIGNED (STRASSEN)) // Pass calculated ACC_WIDTH
+                     pe_inst (
+                              .clk          (clk),
+                              .clr_n        (clr_n),
+                              .ce           (pe_row_en_dist[pe_pr][pe_pc] & pe_col_en_dist[pe_pr][pe_pc]), // Row and column clock enable
+                              .start        (pe_ctrl_dist[(pe_pr * PE_COLS + pe_pc) * 3 + 2]), // Distributed start signal
+                              .valid_in     (pe_ctrl_dist[(pe_pr * PE_COLS + pe_pc) * 3 + 1]), // Distributed valid_in signal
+                              .last         (pe_ctrl_dist[(pe_pr * PE_COLS + pe_pc) * 3 + 0]), // Distributed last signal
+                              .a            (pe_a_in[pe_pr][pe_pc]), // Input A data               (routed below)
+                              .b            (pe_b_in[pe_pr][pe_pc]), // Input B data               (routed below)
+                              .c            (pe_c_part), // Output accumulated C data (combined below)
+                              .output_valid (pe_valid_part) // Connect the output_valid port
+                              );
 
-                // Instantiate the PE module
-                pe_no_fifo #(.DATA_WIDTH (DATA_WIDTH), .ACC_WIDTH (ACC_WIDTH_PE)) // Pass calculated ACC_WIDTH
-                pe_inst (
-                         .clk          (clk),
-                         .clr_n        (clr_n),
-                         .start        (pe_start_in),    // Broadcast start signal
-                         .valid_in     (pe_valid_in_in), // Broadcast valid_in signal
-                         .last         (pe_last_in),      // Broadcast last signal
-                         .a            (pe_a_in[pe_pr][pe_pc]), // Input A data               (routed below)
-                         .b            (pe_b_in[pe_pr][pe_pc]), // Input B data               (routed below)
-                         .c            (pe_c_out[pe_pr][pe_pc]), // Output accumulated C data (captured below)
-                         .output_valid (pe_output_valid[pe_pr][pe_pc]) // Connect the output_valid port
-                         );
+                     if (K_SPLIT > 1)
+                       begin : ksplit_gen
+                          wire [ACC_WIDTH_PE-1:0] pe_c_part_k1;   // Partial sum of the second K slice
+                          wire                    pe_valid_part_k1;
+                          reg [ACC_WIDTH_PE-1:0]  c_sum_reg;      // Reduction stage: sum of both slices
+                          reg                     c_sum_valid_reg;
 
+                          pe_no_fifo #(.DATA_WIDTH (DATA_WIDTH), .ACC_WIDTH (ACC_WIDTH_PE), .MUL_STAGES (PE_MUL_STAGES), .CSA_ACC (PE_CSA_ACC),
+                                       .MUL_FINAL_ADDER (PE_MUL_FINAL_ADDER), .MUL_BOOTH (PE_MUL_BOOTH), .DATA_RESET (DATA_RESET),
+                                       .MUL_SIGNED (STRASSEN))
+                          pe_k1_inst (
+                                      .clk          (clk),
+                                      .clr_n        (clr_n),
+                                      .ce           (pe_row_en_dist[pe_pr][pe_pc] & pe_col_en_dist[pe_pr][pe_pc]),
+                                      .start        (pe_ctrl_dist[(pe_pr * PE_COLS + pe_pc) * 3 + 2]), // Both slices share the controls
+                                      .valid_in     (pe_ctrl_dist[(pe_pr * PE_COLS + pe_pc) * 3 + 1]),
+                                      .last         (pe_ctrl_dist[(pe_pr * PE_COLS + pe_pc) * 3 + 0]),
+                                      .a            (pe_a_in_k1[pe_pr][pe_pc]),
+                                      .b            (pe_b_in_k1[pe_pr][pe_pc]),
+                                      .c            (pe_c_part_k1),
+                                      .output_valid (pe_valid_part_k1)
+                                      );
+
+                          always @(posedge clk or negedge clr_n)
+                            begin
+                               if (!clr_n)
+                                 begin
+                                    c_sum_valid_reg <= 1'b0;
+                                 end
+                               else
+                                 begin
+                                    c_sum_valid_reg <= pe_valid_part & pe_valid_part_k1;
+                                 end
+                            end
+
+                          if (DATA_RESET)
+                            begin : sum_rst_gen
+                               always @(posedge clk or negedge clr_n)
+                                 begin
+                                    if (!clr_n)
+                                      begin
+                                         c_sum_reg <= 'b0;
+                                      end
+                                    else if (pe_valid_part & pe_valid_part_k1)
+                                      begin
+                                         c_sum_reg <= pe_c_part + pe_c_part_k1;
+                                      end
+                                 end
+                            end
+                          else
+                            begin : sum_gen
+                               always @(posedge clk)
+                                 begin
+                                    if (pe_valid_part & pe_valid_part_k1)
+                                      begin
+                                         c_sum_reg <= pe_c_part + pe_c_part_k1;
+                                      end
+                                 end
+                            end
+
+                          assign pe_c_out[pe_pr][pe_pc] = c_sum_reg;
+                          assign pe_output_valid[pe_pr][pe_pc] = c_sum_valid_reg;
+                       end
+                     else
+                       begin : kfull_gen
+                          assign pe_c_out[pe_pr][pe_pc] = pe_c_part;
+                          assign pe_output_valid[pe_pr][pe_pc] = pe_valid_part;
+                       end
+                  end
              end
         end
    endgenerate
 
 
+   //--------------------------------------------------------------------------
+   // ROW_GROUPS: staging registers. Row group g of the A/B banks is on the BRAM
+   // outputs while grp_idx_in == g; PE rows/columns of every group but the last
+   // keep it until the PE step. No reset: a stage is always loaded before use.
+   //--------------------------------------------------------------------------
+   always @(posedge clk)
+     begin
+        for (stg_idx = 0; stg_idx < PE_ROWS; stg_idx = stg_idx + 1)
+          begin
+             if (stg_idx / N_BANKS < A_GROUPS - 1 && grp_idx_in == stg_idx / N_BANKS)
+               begin
+                  a_stage[stg_idx] <= dout_a_brams[stg_idx % N_BANKS];
+               end
+          end
+        for (stg_idx = 0; stg_idx < PE_COLS; stg_idx = stg_idx + 1)
+          begin
+             if (stg_idx / N_BANKS < B_GROUPS - 1 && grp_idx_in == stg_idx / N_BANKS)
+               begin
+                  b_stage[stg_idx] <= dout_b_brams[stg_idx % N_BANKS];
+               end
+          end
+     end
+
+
    //--------------------------------------------------------------------------
    // Data Routing from BRAMs (Port A Read) to Independent PEs
    // Route data from A and B BRAMs (Port A) to each independent PE.
    // PE at (pr, pc) (computing C[pr][pc]) needs A[pr][k_idx_in] and B[k_idx_in][pc]
-   // in each accumulation step k_idx_in.
+   // in each accumulation step k_idx_in. All PEs in row pr share one A source
+   // and all PEs in column pc share one B source.
    //--------------------------------------------------------------------------
    always @* // Use always @* for combinational logic
      begin
-        // Connect the output of the corresponding A and B BRAMs to each PE input 'a' and 'b'
+        // --- Select the A source of each PE row ---
         for (pr_idx = 0; pr_idx < PE_ROWS; pr_idx = pr_idx + 1)
           begin
-             for (pc_idx = 0; pc_idx < PE_COLS; pc_idx = pc_idx + 1)
+             // PE row pr_idx needs A[pr_idx][k_idx_in]
+             // A[i][k] is in A_BRAM[i % N_BANKS] at address (i / N_BANKS) * K + k
+             // (SKEW: in A_BRAM[(i + k) % N_BANKS])
+             a_bank_idx = SKEW ? (pr_idx + k_idx_in) % N_BANKS : pr_idx % N_BANKS;
+             if (pr_idx < M && k_idx_in < K && SMALL_MATRIX)
+               begin // Read A[pr_idx][k_idx_in] from the register file
+                  a_row_src[pr_idx] = a_rf[a_bank_idx * RF_DEPTH_A + (pr_idx / N_BANKS) * K + k_idx_in];
+               end
+             else if (pr_idx < M && k_idx_in < K)
+               begin // Ensure indices are within bounds
+                  // Connect the output of the relevant A BRAM bank (ROW_GROUPS: the
+                  // staged copy unless the row is in the bank's last group)
+                  a_row_src[pr_idx] = (pr_idx / N_BANKS < A_GROUPS - 1) ? a_stage[pr_idx] : dout_a_brams[a_bank_idx];
+               end
+             else
                begin
+                  a_row_src[pr_idx] = {DATA_WIDTH{1'b0}}; // Feed 0 if indices are out of bounds
+               end
 
-                  // --- Route A data to pe_a_in[pr_idx][pc_idx] ---
-                  // PE at (pr_idx, pc_idx) needs A[pr_idx][k_idx_in]
-                  // A[i][k] is in A_BRAM[i % N_BANKS] at address (i / N_BANKS) * K + k
-                  a_bank_idx = pr_idx % N_BANKS;
-                  if (pr_idx < M && k_idx_in < K)
-                    begin // Ensure indices are within bounds
-                       pe_a_in[pr_idx][pc_idx] = dout_a_brams[a_bank_idx]; // Connect the output of the relevant A BRAM bank
-                    end
-                  else
-                    begin
-                       pe_a_in[pr_idx][pc_idx] = {DATA_WIDTH{1'b0}}; // Feed 0 if indices are out of bounds
-                    end
+             // Second K slice (K_SPLIT): A[pr_idx][k_idx_in + K_STEPS]
+             if (K_SPLIT > 1 && pr_idx < M && k_idx_in + K_STEPS < K && SMALL_MATRIX)
+               begin
+                  a_row_src_k1[pr_idx] = a_rf[a_bank_idx * RF_DEPTH_A + (pr_idx / N_BANKS) * K + k_idx_in + K_STEPS];
+               end
+             else if (K_SPLIT > 1 && pr_idx < M && k_idx_in + K_STEPS < K)
+               begin
+                  a_row_src_k1[pr_idx] = dout_a_brams_k1[a_bank_idx];
+               end
+             else
+               begin
+                  a_row_src_k1[pr_idx] = {DATA_WIDTH{1'b0}}; // Past the end of K (odd K) or no second slice
+               end
+          end
+
+        // --- Select the B source of each PE column ---
+        for (pc_idx = 0; pc_idx < PE_COLS; pc_idx = pc_idx + 1)
+          begin
+             // PE column pc_idx needs B[k_idx_in][pc_idx]
+             // B[k][j] is in B_BRAM[j % N_BANKS] at address k * B_GROUPS + j / N_BANKS
+             // The controller is driving the B BRAMs (Port A) with addresses to provide B[k_idx_in][pc_idx]
+             // to the banks needed by the PEs in that column.
+             // (SKEW: B[k][j] is in B_BRAM[(k + j) % N_BANKS])
+             b_bank_idx = SKEW ? (pc_idx + k_idx_in) % N_BANKS : pc_idx % N_BANKS;
+             if (k_idx_in < K && pc_idx < N && SMALL_MATRIX)
+               begin // Read B[k_idx_in][pc_idx] from the register file
+                  b_col_src[pc_idx] = b_rf[b_bank_idx * RF_DEPTH_B + k_idx_in * B_GROUPS + pc_idx / N_BANKS];
+               end
+             else if (k_idx_in < K && pc_idx < N)
+               begin // Ensure indices are within bounds
+                  // Connect the output of the relevant B BRAM bank (ROW_GROUPS: the
+                  // staged copy unless the column is in the bank's last group)
+                  b_col_src[pc_idx] = (pc_idx / N_BANKS < B_GROUPS - 1) ? b_stage[pc_idx] : dout_b_brams[b_bank_idx];
+               end
+             else
+               begin
+                  b_col_src[pc_idx] = {DATA_WIDTH{1'b0}}; // Feed 0 if indices are out of bounds
+               end
 
+             // Second K slice (K_SPLIT): B[k_idx_in + K_STEPS][pc_idx]
+             if (K_SPLIT > 1 && k_idx_in + K_STEPS < K && pc_idx < N && SMALL_MATRIX)
+               begin
+                  b_col_src_k1[pc_idx] = b_rf[b_bank_idx * RF_DEPTH_B + (k_idx_in + K_STEPS) * B_GROUPS + pc_idx / N_BANKS];
+               end
+             else if (K_SPLIT > 1 && k_idx_in + K_STEPS < K && pc_idx < N)
+               begin
+                  b_col_src_k1[pc_idx] = dout_b_brams_k1[b_bank_idx];
+               end
+             else
+               begin
+                  b_col_src_k1[pc_idx] = {DATA_WIDTH{1'b0}}; // Past the end of K (odd K) or no second slice
+               end
+          end
 
-                  // --- Route B data to pe_b_in[pr_idx][pc_idx] ---
-                  // PE at (pr_idx, pc_idx) needs B[k_idx_in][pc_idx]
-                  // B[k][j] is in B_BRAM[j % N_BANKS] at address k * (N / N_BANKS) + j / N_BANKS
-                  b_bank_idx = pc_idx % N_BANKS;
-                  // The controller is driving the B BRAMs (Port A) with addresses to provide B[k_idx_in][pc_idx]
-                  // to the banks needed by the PEs in that column.
-                  // The data for B[k_idx_in][pc_idx] will appear on dout_b_brams[b_bank_idx].
-                  if (k_idx_in < K && pc_idx < N)
-                    begin // Ensure indices are within bounds
-                       pe_b_in[pr_idx][pc_idx] = dout_b_brams[b_bank_idx]; // Connect the output of the relevant B BRAM bank
+        // --- GEMV: one A row per lane, x broadcast to every column ---
+        for (lane_idx = 0; lane_idx < PE_ROWS*PE_COLS; lane_idx = lane_idx + 1)
+          begin
+             // Lane lane_idx needs A[lane_idx][k_idx_in], from A_BRAM[lane_idx % N_BANKS]
+             a_bank_idx = lane_idx % N_BANKS;
+             if (GEMV && lane_idx < M && k_idx_in < K && SMALL_MATRIX)
+               begin
+                  a_lane_src[lane_idx] = a_rf[a_bank_idx * RF_DEPTH_A + (lane_idx / N_BANKS) * K + k_idx_in];
+               end
+             else if (GEMV && lane_idx < M && k_idx_in < K)
+               begin
+                  a_lane_src[lane_idx] = dout_a_brams[a_bank_idx];
+               end
+             else
+               begin
+                  a_lane_src[lane_idx] = {DATA_WIDTH{1'b0}};
+               end
+          end
+        if (GEMV)
+          begin
+             for (pc_idx = 0; pc_idx < PE_COLS; pc_idx = pc_idx + 1)
+               begin
+                  // x[k_idx_in] is in B_BRAM[0] at address k_idx_in
+                  if (k_idx_in < K && SMALL_MATRIX)
+                    begin
+                       b_col_src[pc_idx] = b_rf[k_idx_in];
+                    end
+                  else if (k_idx_in < K)
+                    begin
+                       b_col_src[pc_idx] = dout_b_brams[0];
                     end
                   else
                     begin
-                       pe_b_in[pr_idx][pc_idx] = {DATA_WIDTH{1'b0}}; // Feed 0 if indices are out of bounds
+                       b_col_src[pc_idx] = {DATA_WIDTH{1'b0}};
                     end
                end
           end
+
+        // --- Partitioned: each region reads its job's own banks ---
+        for (part_idx = 0; part_idx < PE_ROWS*PART_COLS; part_idx = part_idx + 1)
+          begin
+             // Row i of job g (region row pr / PART_R_SIZE, region column rc) is in A_BRAM[g*PART_R_SIZE + i]
+             part_job = (part_idx / PART_COLS / PART_R_SIZE) * PART_COLS + part_idx % PART_COLS;
+             part_bank = part_job * PART_R_SIZE + (part_idx / PART_COLS) % PART_R_SIZE;
+             if (PART_ROWS*PART_COLS > 1 && k_idx_in < K && part_bank < N_BANKS)
+               begin
+                  a_part_src[part_idx] = dout_a_brams[part_bank];
+               end
+             else
+               begin
+                  a_part_src[part_idx] = {DATA_WIDTH{1'b0}};
+               end
+          end
+        for (part_idx = 0; part_idx < PART_ROWS*PE_COLS; part_idx = part_idx + 1)
+          begin
+             // Column j of job g (region row rr, region column pc / PART_C_SIZE) is in B_BRAM[g*PART_C_SIZE + j]
+             part_job = (part_idx / PE_COLS) * PART_COLS + (part_idx % PE_COLS) / PART_C_SIZE;
+             part_bank = part_job * PART_C_SIZE + (part_idx % PE_COLS) % PART_C_SIZE;
+             if (PART_ROWS*PART_COLS > 1 && k_idx_in < K && part_bank < N_BANKS)
+               begin
+                  b_part_src[part_idx] = dout_b_brams[part_bank];
+               end
+             else
+               begin
+                  b_part_src[part_idx] = {DATA_WIDTH{1'b0}};
+               end
+          end
      end // always @ (*)
 
 
+   //--------------------------------------------------------------------------
+   // Broadcast Distribution Trees
+   // Controls fan out to every PE, A sources to a PE row and B sources to a
+   // PE column. All trees have BCAST_DEPTH levels, so operands and controls
+   // arrive at the PEs in the same cycle.
+   //--------------------------------------------------------------------------
+   bcast_tree #(.WIDTH (3), .N_OUT (PE_ROWS * PE_COLS), .FANOUT (BCAST_FANOUT), .DEPTH (BCAST_DEPTH))
+   ctrl_tree_inst (
+                   .clk   (clk),
+                   .clr_n (clr_n),
+                   .ce    (1'b1),
+                   .d     ({pe_start_in, pe_valid_in_in, pe_last_in}),
+                   .q     (pe_ctrl_dist)
+                   );
+
+   generate
+      if (PE_BIT_SERIAL)
+        begin : shift_dist_gen
+           // Plane boundary flag, aligned with the other controls
+           bcast_tree #(.WIDTH (1), .N_OUT (PE_ROWS * PE_COLS), .FANOUT (BCAST_FANOUT), .DEPTH (BCAST_DEPTH))
+           shift_tree_inst (
+                            .clk   (clk),
+                            .clr_n (clr_n),
+                            .ce    (1'b1),
+                            .d     (k_idx_in == 0),
+                            .q     (pe_shift_dist)
+                            );
+        end
+      else
+        begin : no_shift_gen
+           assign pe_shift_dist = {(PE_ROWS * PE_COLS){1'b0}};
+        end
+   endgenerate
+
+   genvar                  dr_gen, dc_gen;
+   generate
+      for (dr_gen = 0; dr_gen < PE_ROWS; dr_gen = dr_gen + 1)
+        begin : a_dist_gen
+           wire [PE_A_WIDTH-1:0]         a_row_op;   // Row operand as presented to the PEs
+           wire [PE_COLS*PE_A_WIDTH-1:0] a_row_dist; // Copies of the row's A operand, one per PE column
+           wire [PE_COLS-1:0]            a_en_dist;  // Copies of the row's clock enable, one per PE column
+
+           if (PE_MUL_BOOTH)
+             begin : a_booth_gen
+                // One recoder per row, shared by all PE_COLS multipliers of the row
+                booth_encoder #(.N (DATA_WIDTH)) a_booth_inst (.a      (a_row_src[dr_gen]),
+                                                               .digits (a_row_op));
+             end
+           else
+             begin : a_plain_gen
+                assign a_row_op = a_row_src[dr_gen];
+             end
+
+           if (PART_ROWS * PART_COLS > 1)
+             begin : a_part_gen
+                // One tree per region column: the row's operand in full-array mode,
+                // the region's own job operand when partitioned
+                genvar rc_gen;
+                for (rc_gen = 0; rc_gen < PART_COLS; rc_gen = rc_gen + 1)
+                  begin : a_region_gen
+                     wire [PE_A_WIDTH-1:0] a_region_op = part_en_in ? a_part_src[dr_gen * PART_COLS + rc_gen] : a_row_op;
+
+                     bcast_tree #(.WIDTH (PE_A_WIDTH), .N_OUT (PART_C_SIZE), .FANOUT (BCAST_FANOUT), .DEPTH (BCAST_DEPTH), .RESET (DATA_RESET))
+                     a_region_tree_inst (
+                                         .clk   (clk),
+                                         .clr_n (clr_n),
+                                         .ce    (row_en[dr_gen]),
+                                         .d     (a_region_op),
+                                         .q     (a_row_dist[rc_gen * PART_C_SIZE * PE_A_WIDTH +: PART_C_SIZE * PE_A_WIDTH])
+                                         );
+                  end
+             end
+           else
+             begin : a_full_gen
+                bcast_tree #(.WIDTH (PE_A_WIDTH), .N_OUT (PE_COLS), .FANOUT (BCAST_FANOUT), .DEPTH (BCAST_DEPTH), .RESET (DATA_RESET))
+                a_tree_inst (
+                             .clk   (clk),
+                             .clr_n (clr_n),
+                             .ce    (row_en[dr_gen]), // Frozen with its PE row
+                             .d     (a_row_op),
+                             .q     (a_row_dist)
+                             );
+             end
+
+           // The row enable travels with the controls so it reaches the PEs aligned with them
+           bcast_tree #(.WIDTH (1), .N_OUT (PE_COLS), .FANOUT (BCAST_FANOUT), .DEPTH (BCAST_DEPTH))
+           a_en_tree_inst (
+                           .clk   (clk),
+                           .clr_n (clr_n),
+                           .ce    (1'b1),
+                           .d     (row_en[dr_gen]),
+                           .q     (a_en_dist)
+                           );
+
+           for (dc_gen = 0; dc_gen < PE_COLS; dc_gen = dc_gen + 1)
+             begin : a_dist_col_gen
+                if (GEMV)
+                  begin : a_lane_gen
+                     // Each lane has its own A operand: a one-output tree keeps the
+                     // BCAST_DEPTH alignment with the controls
+                     wire [PE_A_WIDTH-1:0] a_lane_op;
+                     wire [PE_A_WIDTH-1:0] a_lane_dist;
+
+                     if (PE_MUL_BOOTH)
+                       begin : a_lane_booth_gen
+                          booth_encoder #(.N (DATA_WIDTH)) a_lane_booth_inst (.a      (a_lane_src[dr_gen * PE_COLS + dc_gen]),
+                                                                              .digits (a_lane_op));
+                       end
+                     else
+                       begin : a_lane_plain_gen
+                          assign a_lane_op = a_lane_src[dr_gen * PE_COLS + dc_gen];
+                       end
+
+                     bcast_tree #(.WIDTH (PE_A_WIDTH), .N_OUT (1), .FANOUT (BCAST_FANOUT), .DEPTH (BCAST_DEPTH), .RESET (DATA_RESET))
+                     a_lane_tree_inst (
+                                       .clk   (clk),
+                                       .clr_n (clr_n),
+                                       .ce    (row_en[dr_gen]),
+                                       .d     (a_lane_op),
+                                       .q     (a_lane_dist)
+                                       );
+
+                     assign pe_a_in[dr_gen][dc_gen] = a_lane_dist;
+                  end
+                else
+                  begin : a_row_gen
+                     assign pe_a_in[dr_gen][dc_gen] = a_row_dist[dc_gen * PE_A_WIDTH +: PE_A_WIDTH];
+                  end
+                assign pe_row_en_dist[dr_gen][dc_gen] = PE_CLOCK_GATING ? a_en_dist[dc_gen] : 1'b1;
+             end
+
+           if (K_SPLIT > 1)
+             begin : a_k1_gen
+                wire [PE_A_WIDTH-1:0]         a_row_op_k1;   // Second-slice row operand
+                wire [PE_COLS*PE_A_WIDTH-1:0] a_row_dist_k1;
+
+                if (PE_MUL_BOOTH)
+                  begin : a_booth_k1_gen
+                     booth_encoder #(.N (DATA_WIDTH)) a_booth_k1_inst (.a      (a_row_src_k1[dr_gen]),
+                                                                       .digits (a_row_op_k1));
+                  end
+                else
+                  begin : a_plain_k1_gen
+                     assign a_row_op_k1 = a_row_src_k1[dr_gen];
+                  end
+
+                bcast_tree #(.WIDTH (PE_A_WIDTH), .N_OUT (PE_COLS), .FANOUT (BCAST_FANOUT), .DEPTH (BCAST_DEPTH), .RESET (DATA_RESET))
+                a_k1_tree_inst (
+                                .clk   (clk),
+                                .clr_n (clr_n),
+                                .ce    (row_en[dr_gen]),
+                                .d     (a_row_op_k1),
+                                .q     (a_row_dist_k1)
+                                );
+
+                for (dc_gen = 0; dc_gen < PE_COLS; dc_gen = dc_gen + 1)
+                  begin : a_k1_col_gen
+                     assign pe_a_in_k1[dr_gen][dc_gen] = a_row_dist_k1[dc_gen * PE_A_WIDTH +: PE_A_WIDTH];
+                  end
+             end
+        end
+
+      for (dc_gen = 0; dc_gen < PE_COLS; dc_gen = dc_gen + 1)
+        begin : b_dist_gen
+           wire [PE_B_WIDTH-1:0]         b_col_op;   // Column operand as presented to the PEs
+           wire [PE_ROWS*PE_B_WIDTH-1:0] b_col_dist; // Copies of the column's B operand, one per PE row
+           wire [PE_ROWS-1:0]            b_en_dist;  // Copies of the column's clock enable, one per PE row
+
+           if (PE_BIT_SERIAL)
+             begin : b_bit_gen
+                // One bit-plane select per column, shared by all PE_ROWS PEs
+                assign b_col_op = b_col_src[dc_gen][pe_bit_idx_in];
+             end
+           else
+             begin : b_word_gen
+                assign b_col_op = b_col_src[dc_gen];
+             end
+
+           if (PART_ROWS * PART_COLS > 1)
+             begin : b_part_gen
+                // One tree per region row (see a_part_gen)
+                genvar rr_gen;
+                for (rr_gen = 0; rr_gen < PART_ROWS; rr_gen = rr_gen + 1)
+                  begin : b_region_gen
+                     wire [PE_B_WIDTH-1:0] b_region_op = part_en_in ? b_part_src[rr_gen * PE_COLS + dc_gen] : b_col_op;
+
+                     bcast_tree #(.WIDTH (PE_B_WIDTH), .N_OUT (PART_R_SIZE), .FANOUT (BCAST_FANOUT), .DEPTH (BCAST_DEPTH), .RESET (DATA_RESET))
+                     b_region_tree_inst (
+                                         .clk   (clk),
+                                         .clr_n (clr_n),
+                                         .ce    (col_en[dc_gen]),
+                                         .d     (b_region_op),
+                                         .q     (b_col_dist[rr_gen * PART_R_SIZE * PE_B_WIDTH +: PART_R_SIZE * PE_B_WIDTH])
+                                         );
+                  end
+             end
+           else
+             begin : b_full_gen
+                bcast_tree #(.WIDTH (PE_B_WIDTH), .N_OUT (PE_ROWS), .FANOUT (BCAST_FANOUT), .DEPTH (BCAST_DEPTH), .RESET (DATA_RESET))
+                b_tree_inst (
+                             .clk   (clk),
+                             .clr_n (clr_n),
+                             .ce    (col_en[dc_gen]), // Frozen with its PE column
+                             .d     (b_col_op),
+                             .q     (b_col_dist)
+                             );
+             end
+
+           bcast_tree #(.WIDTH (1), .N_OUT (PE_ROWS), .FANOUT (BCAST_FANOUT), .DEPTH (BCAST_DEPTH))
+           b_en_tree_inst (
+                           .clk   (clk),
+                           .clr_n (clr_n),
+                           .ce    (1'b1),
+                           .d     (col_en[dc_gen]),
+                           .q     (b_en_dist)
+                           );
+
+           for (dr_gen = 0; dr_gen < PE_ROWS; dr_gen = dr_gen + 1)
+             begin : b_dist_row_gen
+                assign pe_b_in[dr_gen][dc_gen] = b_col_dist[dr_gen * PE_B_WIDTH +: PE_B_WIDTH];
+                assign pe_col_en_dist[dr_gen][dc_gen] = PE_CLOCK_GATING ? b_en_dist[dr_gen] : 1'b1;
+             end
+
+           if (K_SPLIT > 1)
+             begin : b_k1_gen
+                wire [PE_ROWS*DATA_WIDTH-1:0] b_col_dist_k1; // Second-slice column operand copies
+
+                bcast_tree #(.WIDTH (DATA_WIDTH), .N_OUT (PE_ROWS), .FANOUT (BCAST_FANOUT), .DEPTH (BCAST_DEPTH), .RESET (DATA_RESET))
+                b_k1_tree_inst (
+                                .clk   (clk),
+                                .clr_n (clr_n),
+                                .ce    (col_en[dc_gen]),
+                                .d     (b_col_src_k1[dc_gen]),
+                                .q     (b_col_dist_k1)
+                                );
+
+                for (dr_gen = 0; dr_gen < PE_ROWS; dr_gen = dr_gen + 1)
+                  begin : b_k1_row_gen
+                     assign pe_b_in_k1[dr_gen][dc_gen] = b_col_dist_k1[dr_gen * DATA_WIDTH +: DATA_WIDTH];
+                  end
+             end
+        end
+   endgenerate
+
+
    //--------------------------------------------------------------------------
    // PE Output Buffer Logic
    //--------------------------------------------------------------------------
@@ -340,46 +1362,91 @@ module datapath
         if (!clr_n)
           begin
              pe_output_buffer_valid_out <= 1'b0;
-             for (i = 0; i < PE_ROWS*PE_COLS; i = i + 1)
-               begin
-                  pe_output_buffer[i] <= 'b0;
-               end
           end
         else
           begin
              if (pe_output_buffer_reset)
                begin
                   pe_output_buffer_valid_out <= 1'b0;
-                  for (i = 0; i < PE_ROWS*PE_COLS; i = i + 1)
-                    begin
-                       pe_output_buffer[i] <= 'b0;
-                    end
                end
              // Capture PE outputs when the controller enables it.
              // The controller should assert pe_output_capture_en based on pe_outputs_valid_out.
              else if (pe_output_capture_en)
                begin
                   pe_output_buffer_valid_out <= 1'b1; // Signal that the buffer has valid data
-                  // Capture all PE outputs into the flattened buffer
-                  for (i = 0; i < PE_ROWS; i = i + 1)
-                    begin
-                       for (j = 0; j < PE_COLS; j = j + 1)
-                         begin
-                            pe_output_buffer[i * PE_COLS + j] <= pe_c_out[i][j];
-                         end
-                    end
                end
-             // Invalidate the buffer after the last element is written to C BRAM
-             else if (pe_output_buffer_valid_out && pe_write_idx_in == PE_ROWS*PE_COLS - 1 && en_c_bram_in && we_c_bram_in)
+             // Invalidate the buffer after the last writeback cycle, whether or not
+             // that element is written (AGU bounds drop we_c_bram_in only)
+             else if (pe_output_buffer_valid_out && pe_write_idx_in == N_RESULTS - 1 && en_c_bram_in)
                begin
                   pe_output_buffer_valid_out <= 1'b0;
                end
           end
      end
 
+   // Buffer contents. With DATA_RESET = 0 the entries are only ever loaded by a
+   // capture: they are read out only while pe_output_buffer_valid_out is set.
+   generate
+      if (DATA_RESET)
+        begin : buf_data_rst_gen
+           always @(posedge clk or negedge clr_n)
+             begin
+                if (!clr_n)
+                  begin
+                     for (i = 0; i < PE_ROWS*PE_COLS; i = i + 1)
+                       begin
+                          pe_output_buffer[i] <= 'b0;
+                       end
+                  end
+                else if (pe_output_buffer_reset)
+                  begin
+                     for (i = 0; i < PE_ROWS*PE_COLS; i = i + 1)
+                       begin
+                          pe_output_buffer[i] <= 'b0;
+                       end
+                  end
+                else if (pe_output_capture_en)
+                  begin
+                     // Capture all PE outputs into the flattened buffer
+                     for (i = 0; i < PE_ROWS; i = i + 1)
+                       begin
+                          for (j = 0; j < PE_COLS; j = j + 1)
+                            begin
+                               pe_output_buffer[i * PE_COLS + j] <= pe_c_out[i][j];
+                            end
+                       end
+                  end
+             end
+        end
+      else
+        begin : buf_data_gen
+           always @(posedge clk)
+             begin
+                if (pe_output_capture_en)
+                  begin
+                     // Capture all PE outputs into the flattened buffer
+                     for (i = 0; i < PE_ROWS; i = i + 1)
+                       begin
+                          for (j = 0; j < PE_COLS; j = j + 1)
+                            begin
+                               pe_output_buffer[i * PE_COLS + j] <= pe_c_out[i][j];
+                            end
+                       end
+                  end
+             end
+        end
+   endgenerate
+
    // Output the PE results from the buffer based on the write index
    // This data is fed to the C BRAM write port.
-   assign din_c_bram = pe_output_buffer[pe_write_idx_in];
+   // Partitioned mode writes each job's results contiguously: write index w is
+   // element (i, j) of job g, held by PE (rr*PART_R_SIZE + i, rc*PART_C_SIZE + j).
+   wire [$clog2(PE_ROWS*PE_COLS)-1:0] part_job_idx = pe_write_idx_in / (PART_R_SIZE * PART_C_SIZE);
+   wire [$clog2(PE_ROWS*PE_COLS)-1:0] part_elem_idx = pe_write_idx_in % (PART_R_SIZE * PART_C_SIZE);
+   wire [$clog2(PE_ROWS*PE_COLS)-1:0] part_buf_idx = ((part_job_idx / PART_COLS) * PART_R_SIZE + part_elem_idx / PART_C_SIZE) * PE_COLS +
+                                                     (part_job_idx % PART_COLS) * PART_C_SIZE + part_elem_idx % PART_C_SIZE;
+
+   assign din_c_bram = pe_output_buffer[(PART_ROWS * PART_COLS > 1 && part_en_in) ? part_buf_idx : pe_write_idx_in];
 
    // The pe_c_out_out port is a flattened vector of all PE outputs before buffering.
    // This assignment is handled by the generate block above.
@@ -1,10 +1,14 @@
 module multiplier_carrysave
 #(
-    parameter N = 24  // Data width parameter
+    parameter N = 24,          // Data width parameter
+    parameter FINAL_ADDER = 0  // Final (row N) adder: 0 = ripple row of multiplier_adder cells,
+                               // 1 = Kogge-Stone, 2 = Brent-Kung, 3 = Han-Carlson prefix_adder
 )(
     input  wire [N-1:0]    a,  // Multiplicand
     input  wire [N-1:0]    b,  // Multiplier
-    output wire [N*2-1:0]  p   // Product
+    output wire [N*2-1:0]  p,  // Product
+    output wire [N*2-1:0]  ps, // Product in carry-save form: sum vector
+    output wire [N*2-1:0]  pc  // Product in carry-save form: carry vector (ps + pc == p)
 );
 
     // Internal signals
@@ -15,30 +19,54 @@ module multiplier_carrysave
         genvar i, j;
 
         // Generate multiplier array
+        // Row N (the ripple final adder) is only built when FINAL_ADDER == 0
         for (i = 0; i <= N; i = i + 1) begin : gen_rows
-            for (j = 0; j < N; j = j + 1) begin : gen_columns
-                // Instantiate multiplier-adder block
-                multiplier_adder ma(
-                    .a  ( (i < N) ? a[j] : ((j > 0) ? c[N][j-1] : 1'b0)),
-                    .b  ( (i < N) ? b[i] : 1'b1),
-                    .s_in ( (i > 0 && j < N-1) ? s[i-1][j+1] : 1'b0),
-                    .c_in ( (i > 0) ? c[i-1][j] : 1'b0),
-                    .s_out ( s[i][j] ),
-                    .c_out ( c[i][j] )
-                );
-
-                // Assign upper product bits in final row
-                if (i == N) begin
-                    assign p[N+j] = s[N][j];
+            if (i < N || FINAL_ADDER == 0) begin : gen_array_row
+                for (j = 0; j < N; j = j + 1) begin : gen_columns
+                    // Instantiate multiplier-adder block
+                    multiplier_adder ma(
+                        .a  ( (i < N) ? a[j] : ((j > 0) ? c[N][j-1] : 1'b0)),
+                        .b  ( (i < N) ? b[i] : 1'b1),
+                        .s_in ( (i > 0 && j < N-1) ? s[i-1][j+1] : 1'b0),
+                        .c_in ( (i > 0) ? c[i-1][j] : 1'b0),
+                        .s_out ( s[i][j] ),
+                        .c_out ( c[i][j] )
+                    );
+
+                    // Assign upper product bits in final row
+                    if (i == N) begin
+                        assign p[N+j] = s[N][j];
+                    end
                 end
             end
 
             // Assign lower product bits
-            assign p[i] = s[i][0];
+            if (i < N) begin
+                assign p[i] = s[i][0];
+            end
+        end
+
+        // Parallel-prefix final adder: resolves the row N-1 sum/carry pair in
+        // O(log N) levels instead of rippling c[N][j-1] through N cells
+        if (FINAL_ADDER != 0) begin : gen_prefix_final
+            prefix_adder #(.WIDTH(N), .ARCH(FINAL_ADDER)) final_adder(
+                .a   ( ps[N*2-1:N] ),
+                .b   ( pc[N*2-1:N] ),
+                .sum ( p[N*2-1:N] )
+            );
         end
 
         // Note: Last carry is intentionally ignored
         // Instead of: assign p[N*2] = c[N][N-1];
+
+        // Redundant (carry-save) product taken before the final ripple row:
+        // the upper half is the sum/carry pair that row N would resolve.
+        for (j = 0; j < N; j = j + 1) begin : gen_redundant
+            assign ps[j]     = s[j][0];
+            assign ps[N + j] = (j < N-1) ? s[N-1][j+1] : 1'b0;
+            assign pc[j]     = 1'b0;
+            assign pc[N + j] = c[N-1][j];
+        end
     endgenerate
 
 endmodule
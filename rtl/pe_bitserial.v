@@ -0,0 +1,142 @@
+//----------------------------------------------------------------------------
+// Module: pe_bitserial
+// Description: Bit-serial PE. Instead of an N x N multiplier it takes one bit
+//              of 'b' per cycle and adds 'a' (or 0) into the accumulator, so
+//              the whole PE is DATA_WIDTH AND gates and one ACC_WIDTH adder.
+//
+//              The controller sequences bit planes MSB first, each plane a
+//              full pass over K (plane p, steps k = 0..K-1). The accumulator
+//              is doubled on the first step of every plane ('shift'), so after
+//              the last plane (bit 0) it holds sum_k a[k] * b[k] (Horner form):
+//
+//                acc = sum_p 2^p * sum_k (b[k][p] ? a[k] : 0)
+//
+//              A job at precision P takes P * K steps instead of K. Handshake
+//              matches pe_no_fifo: 'start' clears, output_valid follows the
+//              step tagged 'last' (the last k of plane 0).
+//
+// Pipeline (LATENCY = 2):
+// - stage 1: partial product (b ? a : 0), shift/valid/last flags
+// - stage 2: accumulator
+//----------------------------------------------------------------------------
+module pe_bitserial
+#(
+  parameter DATA_WIDTH = 32,
+  parameter ACC_WIDTH = DATA_WIDTH*2,
+  parameter DATA_RESET = 1            // 0: no clr_n on the partial-product and accumulator registers
+)
+(
+ input                  clk,
+ input                  clr_n,
+ input                  ce,          // Clock enable: low freezes every pipeline register
+ input                  start,       // Start of a new accumulation (clears accumulator)
+ input                  valid_in,    // Valid input data for accumulation step
+ input                  last,        // Last input data for accumulation step
+ input                  shift,       // First step of a bit plane: double the accumulator
+ input [DATA_WIDTH-1:0] a,
+ input                  b,           // Current bit plane of the 'b' operand
+ output [ACC_WIDTH-1:0] c,           // Final accumulated output
+ output                 output_valid // Indicates when 'c' is valid
+);
+
+   // PE pipeline latency from input registration to output_valid high
+   localparam LATENCY = 2;
+
+   // Pipeline stage 1: partial product
+   reg [DATA_WIDTH-1:0]    pp_reg;
+   reg                     stage1_valid_reg; // Valid flag for stage 1
+   reg                     shift_reg1;       // Pipelined 'shift' signal
+   reg                     last_reg1;        // Pipelined 'last' signal
+
+   // Pipeline stage 2: accumulation
+   reg [ACC_WIDTH-1:0]     acc_reg;
+   reg                     last_reg2;        // Pipelined 'last' signal
+
+   wire [ACC_WIDTH-1:0]    acc_base = shift_reg1 ? {acc_reg[ACC_WIDTH-2:0], 1'b0} : acc_reg;
+   wire [ACC_WIDTH-1:0]    acc_next = acc_base + pp_reg;
+
+   // Control pipeline
+   always @(posedge clk, negedge clr_n)
+     begin
+        if (!clr_n)
+          begin
+             stage1_valid_reg <= 0;
+             shift_reg1 <= 0;
+             last_reg1 <= 0;
+          end
+        else if (ce)
+          begin
+             stage1_valid_reg <= valid_in;
+             shift_reg1 <= valid_in & shift;
+             last_reg1 <= valid_in & last;
+          end
+     end
+
+   always @(posedge clk, negedge clr_n)
+     begin
+        if (!clr_n || (ce && start))
+          begin
+             last_reg2 <= 0;
+          end
+        else if (ce)
+          begin
+             last_reg2 <= stage1_valid_reg & last_reg1;
+          end
+     end
+
+   // Data registers
+   generate
+      if (DATA_RESET)
+        begin : data_rst_gen
+           always @(posedge clk, negedge clr_n)
+             begin
+                if (!clr_n)
+                  begin
+                     pp_reg <= 0;
+                  end
+                else if (ce && valid_in)
+                  begin
+                     pp_reg <= b ? a : {DATA_WIDTH{1'b0}};
+                  end
+             end
+
+           always @(posedge clk, negedge clr_n)
+             begin
+                if (!clr_n || (ce && start))
+                  begin
+                     acc_reg <= 0;
+                  end
+                else if (ce && stage1_valid_reg)
+                  begin
+                     acc_reg <= acc_next;
+                  end
+             end
+        end
+      else
+        begin : data_gen
+           always @(posedge clk)
+             begin
+                if (ce && valid_in)
+                  begin
+                     pp_reg <= b ? a : {DATA_WIDTH{1'b0}};
+                  end
+             end
+
+           always @(posedge clk)
+             begin
+                if (ce && start)
+                  begin
+                     acc_reg <= 0;
+                  end
+                else if (ce && stage1_valid_reg)
+                  begin
+                     acc_reg <= acc_next;
+                  end
+             end
+        end
+   endgenerate
+
+   assign c = acc_reg;
+   assign output_valid = last_reg2;
+
+endmodule // pe_bitserial
@@ -0,0 +1,226 @@
+//----------------------------------------------------------------------------
+// Module: pe_double_pump
+// Description: Two logical PEs sharing one multiplier clocked at twice the
+//              array clock. 'clk2x' must be edge-aligned with 'clk' (same PLL,
+//              every other clk2x rising edge coincides with a clk rising edge).
+//
+//              Both logical PEs take one step per clk cycle, as two pe_no_fifo
+//              instances would. The operands of PE 0 enter the multiplier in
+//              the first half of the clk cycle and those of PE 1 in the second
+//              half; each product is added into its own accumulator. The
+//              results are re-registered in the clk domain, so handshake and
+//              latency match pe_no_fifo with MUL_STAGES = 1, CSA_ACC = 0:
+//              'start' clears, output_valid follows the step tagged 'last'.
+//
+// Phase detection:
+// - 'tog' toggles on every clk edge; clk2x samples it into 'tog_q'. They
+//   differ only in the clk2x cycle right after a clk edge (first half).
+//
+// Pipeline (clk2x cycles, one slot per logical PE):
+// - stage 1: operand mux (PE 0 first half, PE 1 second half) and flags
+// - stage 2: product
+// - stage 3: accumulator of the slot's PE
+// - clk domain: c0/c1/output_valid registers (LATENCY = 3 clk cycles)
+//----------------------------------------------------------------------------
+module pe_double_pump
+#(
+  parameter DATA_WIDTH = 32,
+  parameter ACC_WIDTH = DATA_WIDTH*2,
+  parameter MUL_FINAL_ADDER = 0, // multiplier_carrysave final adder (0 ripple, 1 KS, 2 BK, 3 HC)
+  parameter DATA_RESET = 1       // 0: no clr_n on operand, product and accumulator registers
+)
+(
+ input                  clk,
+ input                  clk2x,       // 2x clock, edge-aligned with clk
+ input                  clr_n,
+ input                  ce,          // Clock enable (clk domain): low drops new steps and freezes the outputs
+ input                  start,       // Start of a new accumulation (clears both accumulators)
+ input                  valid_in,    // Valid input data for accumulation step (both PEs)
+ input                  last,        // Last input data for accumulation step
+ input [DATA_WIDTH-1:0] a0,
+ input [DATA_WIDTH-1:0] b0,
+ input [DATA_WIDTH-1:0] a1,
+ input [DATA_WIDTH-1:0] b1,
+ output [ACC_WIDTH-1:0] c0,          // Final accumulated output of PE 0
+ output [ACC_WIDTH-1:0] c1,          // Final accumulated output of PE 1
+ output                 output_valid // Indicates when 'c0'/'c1' are valid
+);
+
+   // PE latency (clk cycles) from input registration to output_valid high
+   localparam LATENCY = 3;
+
+   // Phase detection
+   reg                     tog;   // clk domain
+   reg                     tog_q; // clk2x domain
+   wire                    first_half = tog ^ tog_q; // clk2x cycle right after a clk edge: PE 0 slot
+
+   // Pipeline stage 1: operand registers
+   reg [DATA_WIDTH-1:0]    a_reg;
+   reg [DATA_WIDTH-1:0]    b_reg;
+   reg                     sel_reg1;         // Logical PE of the slot
+   reg                     stage1_valid_reg; // Valid flag for stage 1
+   reg                     last_reg1;        // Pipelined 'last' signal
+
+   // Pipeline stage 2: product
+   wire [DATA_WIDTH*2-1:0] prod_wire;
+   reg [DATA_WIDTH*2-1:0]  mul_reg;
+   reg                     sel_reg2;
+   reg                     stage2_valid_reg;
+   reg                     last_reg2;
+
+   // Pipeline stage 3: accumulators
+   reg [ACC_WIDTH-1:0]     acc0_reg;
+   reg [ACC_WIDTH-1:0]     acc1_reg;
+   reg                     done_reg;         // Last step of PE 1 accumulated (held for one clk cycle)
+
+   // clk-domain outputs
+   reg [ACC_WIDTH-1:0]     c0_reg;
+   reg [ACC_WIDTH-1:0]     c1_reg;
+   reg                     valid_reg;
+
+   // Flags of the step seen by this slot; sampled in both slots of a clk cycle
+   wire                    step_start = ce & start;
+   wire                    step_valid = ce & valid_in;
+
+   multiplier_carrysave #(.N(DATA_WIDTH), .FINAL_ADDER(MUL_FINAL_ADDER)) csm(.a(a_reg), .b(b_reg), .p(prod_wire), .ps(), .pc());
+
+   always @(posedge clk, negedge clr_n)
+     begin
+        if (!clr_n)
+          begin
+             tog <= 1'b0;
+             valid_reg <= 1'b0;
+          end
+        else
+          begin
+             tog <= ~tog;
+             if (ce)
+               begin
+                  valid_reg <= done_reg;
+               end
+          end
+     end
+
+   // Control pipeline (clk2x), always reset
+   always @(posedge clk2x, negedge clr_n)
+     begin
+        if (!clr_n)
+          begin
+             tog_q <= 1'b0;
+             sel_reg1 <= 1'b0;
+             stage1_valid_reg <= 1'b0;
+             last_reg1 <= 1'b0;
+             sel_reg2 <= 1'b0;
+             stage2_valid_reg <= 1'b0;
+             last_reg2 <= 1'b0;
+             done_reg <= 1'b0;
+          end
+        else
+          begin
+             tog_q <= tog;
+             sel_reg1 <= ~first_half;
+             stage1_valid_reg <= step_valid;
+             last_reg1 <= step_valid & last;
+             sel_reg2 <= sel_reg1;
+             stage2_valid_reg <= stage1_valid_reg;
+             last_reg2 <= stage1_valid_reg & last_reg1;
+             if (step_start && !first_half)
+               begin
+                  done_reg <= 1'b0;
+               end
+             else if (sel_reg2)
+               begin
+                  done_reg <= stage2_valid_reg & last_reg2;
+               end
+          end
+     end
+
+   // Data registers: each accumulator is cleared in its own slot of the start cycle
+   generate
+      if (DATA_RESET)
+        begin : data_rst_gen
+           always @(posedge clk2x, negedge clr_n)
+             begin
+                if (!clr_n)
+                  begin
+                     a_reg <= 0;
+                     b_reg <= 0;
+                     mul_reg <= 0;
+                     acc0_reg <= 0;
+                     acc1_reg <= 0;
+                  end
+                else
+                  begin
+                     if (step_valid)
+                       begin
+                          a_reg <= first_half ? a0 : a1;
+                          b_reg <= first_half ? b0 : b1;
+                       end
+                     if (stage1_valid_reg)
+                       begin
+                          mul_reg <= prod_wire;
+                       end
+                     if (step_start && first_half)
+                       acc0_reg <= 0;
+                     else if (stage2_valid_reg && !sel_reg2)
+                       acc0_reg <= acc0_reg + mul_reg;
+                     if (step_start && !first_half)
+                       acc1_reg <= 0;
+                     else if (stage2_valid_reg && sel_reg2)
+                       acc1_reg <= acc1_reg + mul_reg;
+                  end
+             end
+
+           always @(posedge clk, negedge clr_n)
+             begin
+                if (!clr_n)
+                  begin
+                     c0_reg <= 0;
+                     c1_reg <= 0;
+                  end
+                else if (ce)
+                  begin
+                     c0_reg <= acc0_reg;
+                     c1_reg <= acc1_reg;
+                  end
+             end
+        end
+      else
+        begin : data_gen
+           always @(posedge clk2x)
+             begin
+                if (step_valid)
+                  begin
+                     a_reg <= first_half ? a0 : a1;
+                     b_reg <= first_half ? b0 : b1;
+                  end
+                if (stage1_valid_reg)
+                  begin
+                     mul_reg <= prod_wire;
+                  end
+                if (step_start && first_half)
+                  acc0_reg <= 0;
+                else if (stage2_valid_reg && !sel_reg2)
+                  acc0_reg <= acc0_reg + mul_reg;
+                if (step_start && !first_half)
+                  acc1_reg <= 0;
+                else if (stage2_valid_reg && sel_reg2)
+                  acc1_reg <= acc1_reg + mul_reg;
+             end
+
+           always @(posedge clk)
+             begin
+                if (ce)
+                  begin
+                     c0_reg <= acc0_reg;
+                     c1_reg <= acc1_reg;
+                  end
+             end
+        end
+   endgenerate
+
+   assign c0 = c0_reg;
+   assign c1 = c1_reg;
+   assign output_valid = valid_reg;
+
+endmodule // pe_double_pump
@@ -1,30 +1,65 @@
 module pe_no_fifo
 #(
   parameter DATA_WIDTH = 32,
-  parameter ACC_WIDTH = DATA_WIDTH*2 // Assuming simple integer accumulation
+  parameter ACC_WIDTH = DATA_WIDTH*2, // Assuming simple integer accumulation
+  parameter MUL_STAGES = 1,           // Register stages after the multiplier (>= 1)
+  parameter MUL_FINAL_ADDER = 0,      // multiplier_carrysave final adder (0 ripple, 1 KS, 2 BK, 3 HC)
+  parameter CSA_ACC = 0,              // 1: keep products and accumulator in carry-save form,
+                                      //    resolve once after 'last' (adds one cycle of latency)
+  parameter MUL_BOOTH = 0,            // 1: 'a' carries radix-4 Booth digits (booth_encoder output)
+                                      //    and the PE uses booth_multiplier
+  parameter DATA_RESET = 1,           // 0: no clr_n on pure data registers (operands, products,
+                                      //    accumulators) so they can pack into DSP blocks;
+                                      //    valid/last flags always keep clr_n
+  parameter MUL_SIGNED = 0            // 1: 'a', 'b' and 'c' are two's complement (array multiplier,
+                                      //    CSA_ACC = 0 only)
 )
 (
  input                  clk,
  input                  clr_n,
+ input                  ce,          // Clock enable: low freezes every pipeline register
  input                  start,       // Start of a new accumulation (clears accumulator)
  input                  valid_in,    // Valid input data for accumulation step
  input                  last,        // Last input data for accumulation step
- input [DATA_WIDTH-1:0] a,
+ input [(MUL_BOOTH ? 3*(DATA_WIDTH/2+1) : DATA_WIDTH)-1:0] a, // Operand, or its Booth digits
  input [DATA_WIDTH-1:0] b,
  output [ACC_WIDTH-1:0] c,           // Final accumulated output
  output                 output_valid // Indicates when 'c' is valid
 );
 
+   // PE pipeline latency from input registration to output_valid high
+   // (stage 1 + MUL_STAGES multiplier stages + stage 3 [+ resolve stage])
+   localparam LATENCY = MUL_STAGES + 2 + CSA_ACC;
+
+   // Width of each carry-save product vector. The array multiplier's pair sums to
+   // the exact product, so 2N bits are zero-extended into the accumulator; the Booth
+   // pair is only exact modulo its reduction width, which is then ACC_WIDTH.
+   localparam CS_WIDTH = (CSA_ACC && MUL_BOOTH && ACC_WIDTH > DATA_WIDTH*2) ? ACC_WIDTH : DATA_WIDTH*2;
+
+   // Width of the product carried down the pipeline: the resolved product, or
+   // its carry-save {carry, sum} pair in CSA_ACC mode
+   localparam PROD_WIDTH = CSA_ACC ? CS_WIDTH*2 : DATA_WIDTH*2;
+
+   // Width of the 'a' operand: plain data, or N/2+1 three-bit Booth digits
+   localparam A_WIDTH = MUL_BOOTH ? 3*(DATA_WIDTH/2+1) : DATA_WIDTH;
+
    // Internal multiplication signals
    wire [DATA_WIDTH*2-1:0] mul_wire;
+   wire [CS_WIDTH-1:0]     mul_sum_wire;     // Carry-save product: sum vector
+   wire [CS_WIDTH-1:0]     mul_carry_wire;   // Carry-save product: carry vector
+   wire [PROD_WIDTH-1:0]   prod_wire;        // Product entering the multiplier stages
+   wire [PROD_WIDTH-1:0]   mul_stage_in;     // Product presented to stage 2
+   wire                    mul_stage_valid;  // Valid flag presented to stage 2
+   wire                    mul_stage_last;   // 'last' flag presented to stage 2
 
    // Pipeline stage 1: inputs
-   reg [DATA_WIDTH-1:0]    a_reg, b_reg;
+   reg [A_WIDTH-1:0]       a_reg;
+   reg [DATA_WIDTH-1:0]    b_reg;
    reg                     stage1_valid_reg; // Valid flag for stage 1
    reg                     last_reg1;        // Pipelined 'last' signal
 
    // Pipeline stage 2: multiplication
-   reg [DATA_WIDTH*2-1:0]  mul_reg;
+   reg [PROD_WIDTH-1:0]    mul_reg;
    reg                     stage2_valid_reg; // Valid flag for stage 2
    reg                     last_reg2;        // Pipelined 'last' signal
 
@@ -33,29 +68,81 @@ module pe_no_fifo
    reg                     stage3_valid_reg; // Valid flag for stage 3
    reg                     last_reg3;        // Pipelined 'last' signal
 
-   // Multiplier instance (assuming multiplier_carrysave is a combinational module)
-   // Ensure multiplier_carrysave is correctly defined elsewhere
-   multiplier_carrysave #(.N(DATA_WIDTH)) csm(.a(a_reg),
-                                              .b(b_reg),
-                                              .p(mul_wire));
+   // CSA_ACC mode: stage 3 holds the accumulator as a sum/carry pair and
+   // acc_reg becomes the stage-4 resolve register
+   reg [ACC_WIDTH-1:0]     acc_sum_reg;
+   reg [ACC_WIDTH-1:0]     acc_carry_reg;
+   reg                     last_reg4;        // Pipelined 'last' signal (resolve stage)
+
+   // Multiplier instance (combinational). With MUL_BOOTH the recoding of 'a'
+   // is done once per row outside the PE, so only the digit selection and
+   // partial-product reduction remain here.
+   generate
+      if (MUL_BOOTH)
+        begin : mul_booth_gen
+           booth_multiplier #(.N(DATA_WIDTH), .FINAL_ADDER(MUL_FINAL_ADDER), .OUT_WIDTH(CS_WIDTH)) bm(.digits(a_reg),
+                                                                                                    .b(b_reg),
+                                                                                                    .p(mul_wire),
+                                                                                                    .ps(mul_sum_wire),
+                                                                                                    .pc(mul_carry_wire));
+        end
+      else
+        begin : mul_array_gen
+           multiplier_carrysave #(.N(DATA_WIDTH), .FINAL_ADDER(MUL_FINAL_ADDER)) csm(.a(a_reg),
+                                                                                        .b(b_reg),
+                                                                                        .p(mul_wire),
+                                                                                        .ps(mul_sum_wire),
+                                                                                        .pc(mul_carry_wire));
+        end
+   endgenerate
+
+   generate
+      if (CSA_ACC)
+        begin : prod_csa_gen
+           assign prod_wire = {mul_carry_wire, mul_sum_wire}; // Skip the multiplier's ripple row
+        end
+      else if (MUL_SIGNED)
+        begin : prod_signed_gen
+           // Signed product from the unsigned array: a_s * b_s = a * b
+           // - 2^N * (a[N-1] ? b : 0) - 2^N * (b[N-1] ? a : 0)  (mod 2^2N)
+           wire [DATA_WIDTH-1:0] corr_a = a_reg[DATA_WIDTH-1] ? b_reg : {DATA_WIDTH{1'b0}};
+           wire [DATA_WIDTH-1:0] corr_b = b_reg[DATA_WIDTH-1] ? a_reg[DATA_WIDTH-1:0] : {DATA_WIDTH{1'b0}};
+
+           assign prod_wire = {mul_wire[DATA_WIDTH*2-1:DATA_WIDTH] - corr_a - corr_b, mul_wire[DATA_WIDTH-1:0]};
+        end
+      else
+        begin : prod_cpa_gen
+           assign prod_wire = mul_wire;
+        end
+   endgenerate
+
+   // Product as added into the accumulator (sign-extended with MUL_SIGNED)
+   wire [ACC_WIDTH-1:0]    prod_acc;
+
+   generate
+      if (MUL_SIGNED && ACC_WIDTH > DATA_WIDTH*2)
+        begin : prod_sext_gen
+           assign prod_acc = {{(ACC_WIDTH-DATA_WIDTH*2){mul_reg[DATA_WIDTH*2-1]}}, mul_reg[DATA_WIDTH*2-1:0]};
+        end
+      else
+        begin : prod_zext_gen
+           assign prod_acc = mul_reg[DATA_WIDTH*2-1:0];
+        end
+   endgenerate
 
    // Stage 1: Input Registration
    always @(posedge clk, negedge clr_n)
      begin
         if (!clr_n)
           begin
-             a_reg <= 0;
-             b_reg <= 0;
              stage1_valid_reg <= 0;
              last_reg1 <= 0;
           end
-        else
+        else if (ce)
           begin
-             // Register inputs and control signals when valid_in is high
+             // Register control signals when valid_in is high
              if (valid_in)
                begin
-                  a_reg <= a;
-                  b_reg <= b;
                   stage1_valid_reg <= 1; // Input stage is valid if valid_in is high
                   last_reg1 <= last;      // Register the 'last' signal
                end
@@ -68,23 +155,131 @@ module pe_no_fifo
           end // else: !if(!clr_n)
      end // always @ (posedge clk, negedge clr_n)
 
+   // Stage 1 data: operands are loaded when valid_in is high
+   generate
+      if (DATA_RESET)
+        begin : s1_data_rst_gen
+           always @(posedge clk, negedge clr_n)
+             begin
+                if (!clr_n)
+                  begin
+                     a_reg <= 0;
+                     b_reg <= 0;
+                  end
+                else if (ce && valid_in)
+                  begin
+                     a_reg <= a;
+                     b_reg <= b;
+                  end
+             end
+        end
+      else
+        begin : s1_data_gen
+           always @(posedge clk)
+             begin
+                if (ce && valid_in)
+                  begin
+                     a_reg <= a;
+                     b_reg <= b;
+                  end
+             end
+        end
+   endgenerate
+
+   // Optional multiplier retiming registers (MUL_STAGES - 1 deep) ahead of stage 2.
+   // They are held by 'ce' like the rest of the pipeline, so a frozen PE keeps its
+   // in-flight products in step with valid/last; register balancing can still move
+   // them into the multiplier array, as all of them share the one enable.
+   generate
+      if (MUL_STAGES > 1)
+        begin : mul_retime_gen
+           reg [PROD_WIDTH-1:0]   mul_retime [MUL_STAGES-2:0];
+           reg [MUL_STAGES-2:0]   valid_retime;
+           reg [MUL_STAGES-2:0]   last_retime;
+           integer                s;
+
+           always @(posedge clk, negedge clr_n)
+             begin
+                if (!clr_n)
+                  begin
+                     valid_retime <= 0;
+                     last_retime <= 0;
+                  end
+                else if (ce)
+                  begin
+                     valid_retime[0] <= stage1_valid_reg;
+                     last_retime[0] <= last_reg1;
+                     for (s = 1; s < MUL_STAGES-1; s = s + 1)
+                       begin
+                          valid_retime[s] <= valid_retime[s-1];
+                          last_retime[s] <= last_retime[s-1];
+                       end
+                  end
+             end
+
+           if (DATA_RESET)
+             begin : retime_data_rst_gen
+                always @(posedge clk, negedge clr_n)
+                  begin
+                     if (!clr_n)
+                       begin
+                          for (s = 0; s < MUL_STAGES-1; s = s + 1)
+                            begin
+                               mul_retime[s] <= 0;
+                            end
+                       end
+                     else if (ce)
+                       begin
+                          mul_retime[0] <= prod_wire;
+                          for (s = 1; s < MUL_STAGES-1; s = s + 1)
+                            begin
+                               mul_retime[s] <= mul_retime[s-1];
+                            end
+                       end
+                  end
+             end
+           else
+             begin : retime_data_gen
+                always @(posedge clk)
+                  begin
+                     if (ce)
+                       begin
+                          mul_retime[0] <= prod_wire;
+                          for (s = 1; s < MUL_STAGES-1; s = s + 1)
+                            begin
+                               mul_retime[s] <= mul_retime[s-1];
+                            end
+                       end
+                  end
+             end
+
+           assign mul_stage_in = mul_retime[MUL_STAGES-2];
+           assign mul_stage_valid = valid_retime[MUL_STAGES-2];
+           assign mul_stage_last = last_retime[MUL_STAGES-2];
+        end
+      else
+        begin : mul_direct_gen
+           assign mul_stage_in = prod_wire;
+           assign mul_stage_valid = stage1_valid_reg;
+           assign mul_stage_last = last_reg1;
+        end
+   endgenerate
+
    // Stage 2: Multiplication Result Registration
    always @(posedge clk, negedge clr_n)
      begin
         if (!clr_n)
           begin
-             mul_reg <= 0;
              stage2_valid_reg <= 0;
              last_reg2 <= 0;
           end
-        else
+        else if (ce)
           begin
-             // Register multiplication result and control signals if stage 1 was valid
-             if (stage1_valid_reg)
+             // Register control signals if stage 1 was valid
+             if (mul_stage_valid)
                begin
-                  mul_reg <= mul_wire;
                   stage2_valid_reg <= 1; // Stage 2 is valid if stage 1 was valid
-                  last_reg2 <= last_reg1; // Propagate pipelined 'last'
+                  last_reg2 <= mul_stage_last; // Propagate pipelined 'last'
                end
              else
                begin
@@ -94,48 +289,212 @@ module pe_no_fifo
           end
      end
 
+   // Stage 2 data: multiplication result is loaded if stage 1 was valid
+   generate
+      if (DATA_RESET)
+        begin : s2_data_rst_gen
+           always @(posedge clk, negedge clr_n)
+             begin
+                if (!clr_n)
+                  begin
+                     mul_reg <= 0;
+                  end
+                else if (ce && mul_stage_valid)
+                  begin
+                     mul_reg <= mul_stage_in;
+                  end
+             end
+        end
+      else
+        begin : s2_data_gen
+           always @(posedge clk)
+             begin
+                if (ce && mul_stage_valid)
+                  begin
+                     mul_reg <= mul_stage_in;
+                  end
+             end
+        end
+   endgenerate
+
    // Stage 3: Accumulation
-   always @(posedge clk, negedge clr_n)
-     begin
-        if (!clr_n || start)
-          begin
-             acc_reg <= 0;
-             stage3_valid_reg <= 0;
-             last_reg3 <= 0;
-          end
-        else
-          begin
-             // Accumulate if stage 2 was valid
-             if (stage2_valid_reg)
-               begin
-                  // If 'start' is high (and this is the first valid product), initialize accumulator
-                  // Otherwise, add the current product to the accumulator
-                  //if (start)
-                    //begin
-                      // acc_reg <= mul_reg; // Initialize with the 0
-                    //end
-                  //else
-                    //begin
-                       //acc_reg <= acc_reg + mul_reg; // Accumulate
-                    //end
-                  acc_reg <= acc_reg + mul_reg;
-                  stage3_valid_reg <= 1; // Stage 3 is valid if stage 2 was valid
-                  last_reg3 <= last_reg2; // Propagate pipelined 'last'
-               end
-             else
-               begin
-                  // If stage 2 was not valid, accumulator holds its value, valid flag is low
-                  stage3_valid_reg <= 0;
-                  last_reg3 <= 0;
-               end
-          end
-     end
+   generate
+      if (!CSA_ACC)
+        begin : acc_cpa_gen
+         always @(posedge clk, negedge clr_n)
+           begin
+              if (!clr_n || (ce && start))
+                begin
+                   stage3_valid_reg <= 0;
+                   last_reg3 <= 0;
+                end
+              else if (ce)
+                begin
+                   // Accumulate if stage 2 was valid
+                   if (stage2_valid_reg)
+                     begin
+                        stage3_valid_reg <= 1; // Stage 3 is valid if stage 2 was valid
+                        last_reg3 <= last_reg2; // Propagate pipelined 'last'
+                     end
+                   else
+                     begin
+                        // If stage 2 was not valid, accumulator holds its value, valid flag is low
+                        stage3_valid_reg <= 0;
+                        last_reg3 <= 0;
+                     end
+                end
+           end
+
+           // Accumulator: 'start' clears it, each valid product is added
+           if (DATA_RESET)
+             begin : acc_data_rst_gen
+                always @(posedge clk, negedge clr_n)
+                  begin
+                     if (!clr_n || (ce && start))
+                       begin
+                          acc_reg <= 0;
+                       end
+                     else if (ce && stage2_valid_reg)
+                       begin
+                          acc_reg <= acc_reg + prod_acc;
+                       end
+                  end
+             end
+           else
+             begin : acc_data_gen
+                always @(posedge clk)
+                  begin
+                     if (ce && start)
+                       begin
+                          acc_reg <= 0;
+                       end
+                     else if (ce && stage2_valid_reg)
+                       begin
+                          acc_reg <= acc_reg + prod_acc;
+                       end
+                  end
+             end
+        end
+      else
+        begin : acc_csa_gen
+           // Product pair, zero-extended to the accumulator width (Booth: already that wide)
+           wire [ACC_WIDTH-1:0] prod_sum_ext = mul_reg[CS_WIDTH-1:0];
+           wire [ACC_WIDTH-1:0] prod_carry_ext = mul_reg[CS_WIDTH*2-1:CS_WIDTH];
+           wire [ACC_WIDTH-1:0] csa1_sum, csa1_carry;
+           wire [ACC_WIDTH-1:0] csa2_sum, csa2_carry;
+
+           // 4:2 compression of {acc_sum, acc_carry, prod_sum, prod_carry}:
+           // no carry propagates between bit positions on the per-cycle path
+           carry_save_adder #(.WIDTH(ACC_WIDTH)) csa1(.x     (acc_sum_reg),
+                                                      .y     (acc_carry_reg),
+                                                      .z     (prod_sum_ext),
+                                                      .sum   (csa1_sum),
+                                                      .carry (csa1_carry));
+
+           carry_save_adder #(.WIDTH(ACC_WIDTH)) csa2(.x     (csa1_sum),
+                                                      .y     (csa1_carry),
+                                                      .z     (prod_carry_ext),
+                                                      .sum   (csa2_sum),
+                                                      .carry (csa2_carry));
+
+           always @(posedge clk, negedge clr_n)
+             begin
+                if (!clr_n || (ce && start))
+                  begin
+                     stage3_valid_reg <= 0;
+                     last_reg3 <= 0;
+                  end
+                else if (ce)
+                  begin
+                     if (stage2_valid_reg)
+                       begin
+                          stage3_valid_reg <= 1;
+                          last_reg3 <= last_reg2;
+                       end
+                     else
+                       begin
+                          stage3_valid_reg <= 0;
+                          last_reg3 <= 0;
+                       end
+                  end
+             end
+
+           // Stage 4: single carry-propagate add once the last product is in stage 3
+           always @(posedge clk, negedge clr_n)
+             begin
+                if (!clr_n)
+                  begin
+                     last_reg4 <= 0;
+                  end
+                else if (ce)
+                  begin
+                     last_reg4 <= last_reg3;
+                  end
+             end
+
+           // Redundant accumulator (compress the product in if stage 2 was valid)
+           // and resolve register
+           if (DATA_RESET)
+             begin : acc_data_rst_gen
+                always @(posedge clk, negedge clr_n)
+                  begin
+                     if (!clr_n || (ce && start))
+                       begin
+                          acc_sum_reg <= 0;
+                          acc_carry_reg <= 0;
+                       end
+                     else if (ce && stage2_valid_reg)
+                       begin
+                          acc_sum_reg <= csa2_sum;
+                          acc_carry_reg <= csa2_carry;
+                       end
+                  end
+
+                always @(posedge clk, negedge clr_n)
+                  begin
+                     if (!clr_n)
+                       begin
+                          acc_reg <= 0;
+                       end
+                     else if (ce && last_reg3)
+                       begin
+                          acc_reg <= acc_sum_reg + acc_carry_reg;
+                       end
+                  end
+             end
+           else
+             begin : acc_data_gen
+                always @(posedge clk)
+                  begin
+                     if (ce && start)
+                       begin
+                          acc_sum_reg <= 0;
+                          acc_carry_reg <= 0;
+                       end
+                     else if (ce && stage2_valid_reg)
+                       begin
+                          acc_sum_reg <= csa2_sum;
+                          acc_carry_reg <= csa2_carry;
+                       end
+                  end
+
+                always @(posedge clk)
+                  begin
+                     if (ce && last_reg3)
+                       begin
+                          acc_reg <= acc_sum_reg + acc_carry_reg;
+                       end
+                  end
+             end
+        end
+   endgenerate
 
    // Output Logic
    // The final accumulated result is in acc_reg when the pipelined 'last' signal
    // reaches stage 3 (last_reg3), indicating the last product has been added
    // and the accumulation is complete.
+   // In CSA_ACC mode acc_reg is the resolved sum, valid one cycle later (last_reg4).
    assign c = acc_reg; // Output the accumulator value
-   assign output_valid = last_reg3; // Output is valid when the last product has been added
+   assign output_valid = CSA_ACC ? last_reg4 : last_reg3; // Output is valid when the last product has been added
 
 endmodule // pe_no_fifo
@@ -0,0 +1,167 @@
+//----------------------------------------------------------------------------
+// Module: prefix_adder
+// Description: WIDTH-bit parallel-prefix (carry-lookahead) adder.
+//              sum = a + b (modulo 2^WIDTH), no carry-in, carry-out dropped.
+//              Replaces an O(WIDTH) ripple chain with an O(log WIDTH)
+//              network of generate/propagate prefix cells.
+//
+// Architectures (ARCH):
+// - 1: Kogge-Stone  log2(W) levels, most cells, fan-out 2 (fastest)
+// - 2: Brent-Kung   2*log2(W)-1 levels, fewest cells (smallest)
+// - 3: Han-Carlson  log2(W)+1 levels, Kogge-Stone on odd bits plus a
+//                   final even-bit level (about half the Kogge-Stone cells)
+//
+// Report:
+// - PREFIX_CELLS: number of prefix (black) cells, 3 gates each
+// - PREFIX_DEPTH: number of prefix cell levels on the critical path
+//   Total logic depth is PREFIX_DEPTH + 2 (g/p pre-processing, sum XOR).
+//   See doc/prefix_adder.md for the figures at the usual widths.
+//----------------------------------------------------------------------------
+module prefix_adder
+#(
+  parameter WIDTH = 16, // Operand width
+  parameter ARCH = 1    // 1: Kogge-Stone, 2: Brent-Kung, 3: Han-Carlson
+)
+(
+ input wire [WIDTH-1:0]  a,  // First operand
+ input wire [WIDTH-1:0]  b,  // Second operand
+ output wire [WIDTH-1:0] sum // a + b
+);
+
+   localparam LOG_W = (WIDTH > 1) ? $clog2(WIDTH) : 0;
+   localparam LEVELS = (WIDTH <= 1) ? 0 :
+                       (ARCH == 2) ? 2 * LOG_W - 1 :
+                       (ARCH == 3) ? LOG_W + 1 :
+                       LOG_W;
+
+   // Bit combined into bit i at prefix level 'level', or -1 if bit i passes through
+   function integer partner;
+      input integer level;
+      input integer i;
+      integer       dist;
+      begin
+         partner = -1;
+         if (ARCH == 2)
+           begin
+              if (level < LOG_W)
+                begin
+                   // Up-sweep: bit i gathers the span below it in a binary tree
+                   dist = 1 << level;
+                   if ((i + 1) % (2 * dist) == 0)
+                     partner = i - dist;
+                end
+              else
+                begin
+                   // Down-sweep: fill in the remaining bits from the tree nodes
+                   dist = 1 << (2 * LOG_W - 2 - level);
+                   if ((i + 1) % (2 * dist) == dist && i >= 3 * dist - 1)
+                     partner = i - dist;
+                end
+           end
+         else if (ARCH == 3)
+           begin
+              if (level == 0)
+                begin
+                   // Odd bits absorb their even neighbour
+                   if (i % 2 == 1)
+                     partner = i - 1;
+                end
+              else if (level < LOG_W)
+                begin
+                   // Kogge-Stone across the odd bits
+                   dist = 1 << level;
+                   if (i % 2 == 1 && i >= dist)
+                     partner = i - dist;
+                end
+              else
+                begin
+                   // Even bits take the completed prefix of the odd bit below
+                   if (i % 2 == 0 && i >= 2)
+                     partner = i - 1;
+                end
+           end
+         else
+           begin
+              // Kogge-Stone: every bit combines at every level
+              dist = 1 << level;
+              if (i >= dist)
+                partner = i - dist;
+           end
+      end
+   endfunction
+
+   // Number of prefix cells in the network
+   function integer prefix_cells;
+      input integer dummy;
+      integer       l, i;
+      begin
+         prefix_cells = 0;
+         for (l = 0; l < LEVELS; l = l + 1)
+           for (i = 0; i < WIDTH; i = i + 1)
+             if (partner(l, i) >= 0)
+               prefix_cells = prefix_cells + 1;
+      end
+   endfunction
+
+   // Number of levels that contain at least one prefix cell
+   function integer prefix_depth;
+      input integer dummy;
+      integer       l, i, used;
+      begin
+         prefix_depth = 0;
+         for (l = 0; l < LEVELS; l = l + 1)
+           begin
+              used = 0;
+              for (i = 0; i < WIDTH; i = i + 1)
+                if (partner(l, i) >= 0)
+                  used = 1;
+              prefix_depth = prefix_depth + used;
+           end
+      end
+   endfunction
+
+   localparam PREFIX_CELLS = prefix_cells(0);
+   localparam PREFIX_DEPTH = prefix_depth(0);
+
+   // Group generate/propagate after each level (level 0 = per-bit g/p)
+   wire [(LEVELS+1)*WIDTH-1:0] g_lvl;
+   wire [(LEVELS+1)*WIDTH-1:0] p_lvl;
+
+   assign g_lvl[WIDTH-1:0] = a & b;
+   assign p_lvl[WIDTH-1:0] = a ^ b;
+
+   generate
+      genvar l_gen, i_gen;
+      for (l_gen = 0; l_gen < LEVELS; l_gen = l_gen + 1)
+        begin : gen_levels
+           for (i_gen = 0; i_gen < WIDTH; i_gen = i_gen + 1)
+             begin : gen_bits
+                if (partner(l_gen, i_gen) >= 0)
+                  begin : gen_cell
+                     // Prefix (black) cell: (G, P) = (Gi | Pi & Gj, Pi & Pj)
+                     assign g_lvl[(l_gen+1)*WIDTH + i_gen] = g_lvl[l_gen*WIDTH + i_gen] |
+                                                              (p_lvl[l_gen*WIDTH + i_gen] & g_lvl[l_gen*WIDTH + partner(l_gen, i_gen)]);
+                     assign p_lvl[(l_gen+1)*WIDTH + i_gen] = p_lvl[l_gen*WIDTH + i_gen] & p_lvl[l_gen*WIDTH + partner(l_gen, i_gen)];
+                  end
+                else
+                  begin : gen_pass
+                     assign g_lvl[(l_gen+1)*WIDTH + i_gen] = g_lvl[l_gen*WIDTH + i_gen];
+                     assign p_lvl[(l_gen+1)*WIDTH + i_gen] = p_lvl[l_gen*WIDTH + i_gen];
+                  end
+             end
+        end
+   endgenerate
+
+   // Carry into bit i is the group generate of bits [i-1:0]
+   generate
+      if (WIDTH > 1)
+        begin : gen_sum
+           assign sum = p_lvl[WIDTH-1:0] ^ {g_lvl[LEVELS*WIDTH +: WIDTH-1], 1'b0};
+        end
+      else
+        begin : gen_sum_1bit
+           assign sum = p_lvl[WIDTH-1:0];
+        end
+   endgenerate
+
+endmodule // prefix_adder
@@ -2,9 +2,12 @@
 // Module: matrix_multiplier_top
 // Description: Top-level module connecting the datapath2 and matrix_controller.
 //              Provides the main interface for the matrix multiplication system.
-//              **Uses ONLY Port A for A and B BRAMs (for both loading and execution).**
-//              The external system/testbench must drive the A/B BRAM Port A
-//              inputs for loading when start_mult is low.
+//              **Uses Port A of the A and B BRAMs for loading and execution.**
+//              The external system/testbench must drive the A/B BRAM load
+//              inputs for loading when start_mult is low. Internally, loads go
+//              to Port B instead with LOAD_RATIO > 1 (wide loads) and, while
+//              start_mult is high, with STREAM_K_SLOTS; K_SPLIT and STRASSEN
+//              read through Port B.
 //----------------------------------------------------------------------------
 module top
   #(
@@ -16,56 +19,169 @@ module top
 
     // Parameters for the 2D PE Array dimensions (Must match datapath/controller)
     parameter PE_ROWS = M,     // Number of PE rows = M
-    parameter PE_COLS = N      // Number of PE columns = N
+    parameter PE_COLS = N,     // Number of PE columns = N
+
+    // PE pipeline configuration (shared by datapath and controller)
+    parameter PE_MUL_STAGES = 1, // Register stages after each PE multiplier
+    parameter PE_CSA_ACC = 0,    // 1: carry-save PE accumulators with one final resolve
+    parameter PE_MUL_FINAL_ADDER = 0, // PE multiplier final adder: 0 ripple, 1 Kogge-Stone, 2 Brent-Kung, 3 Han-Carlson
+    parameter PE_MUL_BOOTH = 0,  // 1: radix-4 Booth PE multipliers with per-row shared recoding
+    parameter PE_BIT_SERIAL = 0, // 1: bit-serial PEs, one B bit plane per pass over K (see precision)
+    parameter PE_DOUBLE_PUMP = 0, // 1: one clk2x multiplier per two PE columns (PE_COLS even)
+
+    // Pipelined distribution of PE controls/operands (for large arrays)
+    parameter PE_BCAST_PIPELINE = 0, // 1: insert register trees, depth chosen from PE_ROWS*PE_COLS
+    parameter PE_BCAST_FANOUT = 4,   // Loads driven by each distribution register
+    parameter PE_CLOCK_GATING = 0,   // 1: clock-enable PEs by job row/column and phase (dynamic power)
+
+    // Small-matrix mode: register-file operands, results read from the PEs, no BRAM round trips
+    parameter SMALL_MATRIX = 0,
+
+    // K-split reduction (1 or 2): two PE planes each accumulate half of K, partial sums added before capture
+    parameter K_SPLIT = 1,
+
+    // Spatial partitioning: PE_PART_ROWS x PE_PART_COLS independent regions when 'partition' is high
+    parameter PE_PART_ROWS = 1,
+    parameter PE_PART_COLS = 1,
+
+    // Strassen/Winograd block mode: signed PEs, add/subtract operand loads (load_op) and C block writebacks (c_targets)
+    parameter STRASSEN = 0,
+
+    // Matrix-vector mode: PEs are dot-product lanes, x resident in B bank 0. Each lane
+    //    reads its own A bank, so M <= N_BANKS and only the first M (at most N_BANKS)
+    //    of the PE_ROWS*PE_COLS lanes run; throughput is N_BANKS rows per K steps
+    parameter GEMV = 0,
+
+    // A/B BRAM output pipeline register (adds one cycle of read latency, compensated by the controller)
+    parameter BRAM_OUT_REG = 0,
+
+    // Register reset style
+    parameter DATA_RESET = 1,        // 0: no reset on pure data registers (better DSP/BRAM register packing)
+
+    // Operand stalls: 1 = 'operand_stall' pauses the K loop (needs BRAM_OUT_REG = 0)
+    parameter K_STALL = 0,
+
+    // Streaming K: > 0 = k-slice slots in the A/B banks, filled during the job through
+    //    Port B (loads while start_mult is high) and tracked with slice_valid/slice_free
+    parameter STREAM_K_SLOTS = 0,
+
+    // Convolution mode: im2col A addressing over an input feature map loaded into
+    //    every A bank (conv_* ports, see controller CONV; needs M <= N_BANKS)
+    parameter CONV = 0,
+    parameter CONV_DIM_WIDTH = 8,  // Width of the conv_in_w/h/c, conv_ox/oy fields
+    parameter CONV_IFM_DEPTH = 0,  // A bank words added for the input feature map
+
+    // Programmable address generation: per-job base/stride views of A, B and C and
+    //    K/row/column bounds from the agu_* ports (see controller AGU)
+    parameter AGU = 0,
+
+    // Skewed (diagonal) A/B bank storage: each stored operand can be used as is or
+    //    transposed per job (transpose_a/b), at the same cost (see controller SKEW)
+    parameter SKEW = 0,
+
+    // Wide host loads: din_a/b_brams_in carry LOAD_RATIO words per bank (word w of an
+    //    access at bank address addr + w, addr aligned to LOAD_RATIO), written through
+    //    a LOAD_RATIO-wide Port B; the compute reads keep the one-word Port A
+    //    (see datapath LOAD_RATIO)
+    parameter LOAD_RATIO = 1,
+
+    // Controller configuration
+    parameter CTRL_REGISTERED_OUTPUTS = 1 // Drive datapath controls from flops (lookahead decode)
     )
    (
     input wire                                                                                         clk,             // Clock signal
+    input wire                                                                                         clk2x,           // 2x clock, edge-aligned with clk (used when PE_DOUBLE_PUMP)
     input wire                                                                                         rst_n,           // Asynchronous active-low reset
 
     // External Control Input
     input wire                                                                                         start_mult,      // Start signal to initiate multiplication
+    input wire [$clog2(DATA_WIDTH+1)-1:0]                                                              precision,       // PE_BIT_SERIAL: B bits per element, sampled at start (0 = DATA_WIDTH)
+    input wire                                                                                         partition,       // Run a batch of same-shape jobs, one per PE region (hold for the job)
+    input wire [1:0]                                                                                   load_op,         // STRASSEN: A/B load operation, 0/1 write, 2 add to, 3 subtract from the stored value
+    input wire [7:0]                                                                                   c_targets,       // STRASSEN: per C block b, bits [2b+1:2b] = 0 skip, 1 write, 2 add, 3 subtract (sampled at start)
+    input wire                                                                                         operand_stall,   // K_STALL: an operand source underflows, pause the K loop for a cycle
+    input wire                                                                                         slice_valid,     // STREAM_K_SLOTS: k-slice slot 'slice_slot' has been written (pulse)
+    input wire [((K > 1) ? $clog2(K) : 1)-1:0]                                                         slice_slot,      // STREAM_K_SLOTS: slot of the completed slice
+    output wire [((STREAM_K_SLOTS > 0) ? STREAM_K_SLOTS : 1)-1:0]                                      slice_free,      // STREAM_K_SLOTS: slots that may be (over)written
+    input wire                                                                                         transpose_a,     // SKEW: the next job uses the transpose of the stored A (sampled at start)
+    input wire                                                                                         transpose_b,     // SKEW: the next job uses the transpose of the stored B (sampled at start)
+    input wire                                                                                         agu_en,          // AGU: address the next job through the agu_* fields (sampled at start, as are the fields)
+    input wire [(((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K + CONV_IFM_DEPTH) : 1)-1:0]                agu_a_base,      // AGU: A bank address of row 0, k 0
+    input wire [(((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K + CONV_IFM_DEPTH) : 1)-1:0]                agu_a_stride_r,  // AGU: A address step per row
+    input wire [(((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K + CONV_IFM_DEPTH) : 1)-1:0]                agu_a_stride_k,  // AGU: A address step per k
+    input wire [((K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1)-1:0]                                 agu_b_base,      // AGU: B bank address of column 0, k 0
+    input wire [((K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1)-1:0]                                 agu_b_stride_c,  // AGU: B address step per column
+    input wire [((K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1)-1:0]                                 agu_b_stride_k,  // AGU: B address step per k
+    input wire [((M * N > 0) ? $clog2(M * N * (STRASSEN ? 4 : 1)) : 1)-1:0]                            agu_c_base,      // AGU: C address of element (0, 0)
+    input wire [((M * N > 0) ? $clog2(M * N * (STRASSEN ? 4 : 1)) : 1)-1:0]                            agu_c_stride_r,  // AGU: C address step per row
+    input wire [((M * N > 0) ? $clog2(M * N * (STRASSEN ? 4 : 1)) : 1)-1:0]                            agu_c_stride_c,  // AGU: C address step per column
+    input wire [$clog2(K):0]                                                                           agu_k_len,       // AGU: K steps of the job (0 = K)
+    input wire [$clog2(M+1)-1:0]                                                                       agu_m_len,       // AGU: C rows written back (0 = M)
+    input wire [$clog2(N+1)-1:0]                                                                       agu_n_len,       // AGU: C columns written back (0 = N)
+    input wire                                                                                         conv_en,         // CONV: the next job is a convolution (sampled at start, as are the conv_* fields)
+    input wire [CONV_DIM_WIDTH-1:0]                                                                    conv_in_w,       // CONV: input feature map width W
+    input wire [CONV_DIM_WIDTH-1:0]                                                                    conv_in_h,       // CONV: input feature map height H
+    input wire [CONV_DIM_WIDTH-1:0]                                                                    conv_in_c,       // CONV: input feature map channels C
+    input wire [3:0]                                                                                   conv_kw,         // CONV: kernel width
+    input wire [3:0]                                                                                   conv_kh,         // CONV: kernel height
+    input wire [2:0]                                                                                   conv_stride,     // CONV: stride
+    input wire [2:0]                                                                                   conv_pad,        // CONV: zero padding on every side
+    input wire [CONV_DIM_WIDTH-1:0]                                                                    conv_ox,         // CONV: output column of PE row 0
+    input wire [CONV_DIM_WIDTH-1:0]                                                                    conv_oy,         // CONV: output row of the job
 
     // External Status Output
     output wire                                                                                        mult_done,       // Signal indicating multiplication is complete
 
     input wire                                                                                         en_a_brams_in,   // Enable for A banks (Port A)
-    input wire [N_BANKS * ($clog2(N_BANKS) + ((M/N_BANKS * K > 0) ? $clog2(M/N_BANKS * K) : 1)) - 1:0] addr_a_brams_in, // Address for A banks (Port A)
+    input wire [N_BANKS * ($clog2(N_BANKS) + (((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K + CONV_IFM_DEPTH) : 1)) - 1:0] addr_a_brams_in, // Address for A banks (Port A)
     input wire                                                                                         we_a_brams_in,   // Write enable for A banks (Port A)
-    input wire [N_BANKS * DATA_WIDTH - 1:0]                                                            din_a_brams_in,  // Data input for writing to A banks (Port A)
+    input wire [N_BANKS * DATA_WIDTH * LOAD_RATIO - 1:0]                                               din_a_brams_in,  // Data input for writing to A banks (LOAD_RATIO words per bank)
 
     input wire                                                                                         en_b_brams_in,   // Enable for B banks (Port A)
-    input wire [N_BANKS * ($clog2(N_BANKS) + ((K * N/N_BANKS > 0) ? $clog2(K * N/N_BANKS) : 1)) - 1:0] addr_b_brams_in, // Address for B banks (Port A)
+    input wire [N_BANKS * ($clog2(N_BANKS) + ((K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1)) - 1:0] addr_b_brams_in, // Address for B banks (Port A)
     input wire                                                                                         we_b_brams_in,   // Write enable for B banks (Port A)
-    input wire [N_BANKS * DATA_WIDTH - 1:0]                                                            din_b_brams_in,  // Data input for writing to B banks (Port A)
+    input wire [N_BANKS * DATA_WIDTH * LOAD_RATIO - 1:0]                                               din_b_brams_in,  // Data input for writing to B banks (LOAD_RATIO words per bank)
 
 
     // External C BRAM Read Interface (for reading the final result)
     input wire                                                                                         read_en_c,       // External read enable for C BRAM Port B
-    input wire [((M * N > 0) ? $clog2(M * N) : 1)-1:0]                                                 read_addr_c,     // External read address for C BRAM Port B
+    input wire [((M * N > 0) ? $clog2(M * N * (STRASSEN ? 4 : 1)) : 1)-1:0]                            read_addr_c,     // External read address for C BRAM Port B
     output wire [(DATA_WIDTH * 2 + ((K > 1) ? $clog2(K) : 1))-1:0]                                     dout_c           // Data output from C BRAM
     );
 
    // Derived parameters (matching sub-modules)
 
-   parameter ADDR_WIDTH_A = ($clog2(N_BANKS) + ((M/N_BANKS * K > 0) ? $clog2(M/N_BANKS * K) : 1));
-   parameter ADDR_WIDTH_B = ($clog2(N_BANKS) + ((K * N/N_BANKS > 0) ? $clog2(K * N/N_BANKS) : 1));
-   parameter ADDR_WIDTH_A_BANK = (M/N_BANKS * K > 0) ? $clog2(M/N_BANKS * K) : 1;
-   parameter ADDR_WIDTH_B_BANK = (K * N/N_BANKS > 0) ? $clog2(K * N/N_BANKS) : 1;
-   parameter ADDR_WIDTH_C = (M * N > 0) ? $clog2(M * N) : 1;
+   parameter ADDR_WIDTH_A = ($clog2(N_BANKS) + (((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K + CONV_IFM_DEPTH) : 1));
+   parameter ADDR_WIDTH_B = ($clog2(N_BANKS) + ((K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1));
+   parameter ADDR_WIDTH_A_BANK = ((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K + CONV_IFM_DEPTH) : 1;
+   parameter ADDR_WIDTH_B_BANK = (K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1;
+   parameter ADDR_WIDTH_C = (M * N > 0) ? $clog2(M * N * (STRASSEN ? 4 : 1)) : 1;
    parameter ACC_WIDTH_PE = DATA_WIDTH * 2 + ((K > 1) ? $clog2(K) : 1); // PE accumulator width must match
    parameter N_PE = PE_ROWS * PE_COLS; // Total number of PEs
    parameter ADDR_WIDTH_BANK = $clog2(N_BANKS); // Width of the bank index in the new address format
+   parameter PE_PIPE_DEPTH = PE_BIT_SERIAL ? 2 : PE_DOUBLE_PUMP ? 3 : PE_MUL_STAGES + 2 + PE_CSA_ACC; // PE latency from input registration to output_valid
+   // Distribution tree depth: enough levels of PE_BCAST_FANOUT to reach every PE
+   parameter PE_BCAST_DEPTH = (PE_BCAST_PIPELINE && N_PE > 1) ?
+                              ($clog2(N_PE) + $clog2(PE_BCAST_FANOUT) - 1) / $clog2(PE_BCAST_FANOUT) : 0;
+   parameter BRAM_RD_LATENCY = 1 + BRAM_OUT_REG; // A/B BRAM address-to-data latency
+   parameter ROW_GROUPS = ((M > N ? M : N) + N_BANKS - 1) / N_BANKS; // Bank reads per K step (N_BANKS < M or N)
 
    // Internal Wires to connect Controller and Datapath
    // These wires carry the control signals from the controller to the datapath
    wire [$clog2(K)-1:0] k_idx_in;
+   wire [((DATA_WIDTH > 1) ? $clog2(DATA_WIDTH) : 1)-1:0] pe_bit_idx_in;
+   wire [((ROW_GROUPS > 1) ? $clog2(ROW_GROUPS) : 1)-1:0] grp_idx_in;
    wire                 en_c_bram_in;
    wire                 we_c_bram_in;
    wire [ADDR_WIDTH_C-1:0] addr_c_bram_in;
    wire [$clog2(N_PE)-1:0] pe_write_idx_in;
+   wire [1:0]              c_op_in;
+   wire [N_BANKS-1:0]      a_pad; // CONV: A bank reads in the padding ring
    wire                    pe_start_in;
    wire                    pe_valid_in_in;
    wire                    pe_last_in;
+   wire [PE_ROWS-1:0]      pe_row_en;
+   wire [PE_COLS-1:0]      pe_col_en;
    wire                    pe_output_capture_en;
    wire                    pe_output_buffer_reset;
 
@@ -101,15 +217,20 @@ module top
    wire                                datapath_we_b_brams;
    wire [N_BANKS * DATA_WIDTH - 1:0]   datapath_din_b_brams;
 
-   assign datapath_en_a_brams = start_mult ? ctrl_en_a_brams : en_a_brams_in;
+   assign datapath_en_a_brams = start_mult ? ctrl_en_a_brams : en_a_brams_in && (LOAD_RATIO == 1);
    assign datapath_addr_a_brams = start_mult ? ctrl_addr_a_brams : addr_a_brams_in;
    assign datapath_we_a_brams = start_mult ? ctrl_we_a_brams : we_a_brams_in;
-   assign datapath_din_a_brams = start_mult ? ctrl_din_a_brams : din_a_brams_in;
+   assign datapath_din_a_brams = start_mult ? ctrl_din_a_brams : din_a_brams_in[N_BANKS * DATA_WIDTH - 1:0];
 
-   assign datapath_en_b_brams = start_mult ? ctrl_en_b_brams : en_b_brams_in;
+   assign datapath_en_b_brams = start_mult ? ctrl_en_b_brams : en_b_brams_in && (LOAD_RATIO == 1);
    assign datapath_addr_b_brams = start_mult ? ctrl_addr_b_brams : addr_b_brams_in;
    assign datapath_we_b_brams = start_mult ? ctrl_we_b_brams : we_b_brams_in;
-   assign datapath_din_b_brams = start_mult ? ctrl_din_b_brams : din_b_brams_in;
+   assign datapath_din_b_brams = start_mult ? ctrl_din_b_brams : din_b_brams_in[N_BANKS * DATA_WIDTH - 1:0];
+
+   // Streaming K: loads during the job go to Port B instead
+   // (LOAD_RATIO: all loads do, Port A is only read by the controller)
+   wire                                ld_en_a_brams = en_a_brams_in && (start_mult ? (STREAM_K_SLOTS > 0) : (LOAD_RATIO > 1));
+   wire                                ld_en_b_brams = en_b_brams_in && (start_mult ? (STREAM_K_SLOTS > 0) : (LOAD_RATIO > 1));
 
 
    // Instantiate the Datapath module
@@ -121,10 +242,34 @@ module top
        .N          (N),
        .N_BANKS    (N_BANKS),
        .PE_ROWS    (PE_ROWS),
-       .PE_COLS    (PE_COLS)
+       .PE_COLS    (PE_COLS),
+       .PE_MUL_STAGES (PE_MUL_STAGES),
+       .PE_CSA_ACC (PE_CSA_ACC),
+       .PE_MUL_FINAL_ADDER (PE_MUL_FINAL_ADDER),
+       .PE_MUL_BOOTH (PE_MUL_BOOTH),
+       .PE_BIT_SERIAL (PE_BIT_SERIAL),
+       .PE_DOUBLE_PUMP (PE_DOUBLE_PUMP),
+       .STREAM_K (STREAM_K_SLOTS > 0),
+       .CONV (CONV),
+       .CONV_IFM_DEPTH (CONV_IFM_DEPTH),
+       .SKEW (SKEW),
+       .ROW_GROUPS (ROW_GROUPS),
+       .LOAD_RATIO (LOAD_RATIO),
+       .PART_ROWS (PE_PART_ROWS),
+       .PART_COLS (PE_PART_COLS),
+       .STRASSEN (STRASSEN),
+       .DATA_RESET (DATA_RESET),
+       .BRAM_OUT_REG (BRAM_OUT_REG),
+       .SMALL_MATRIX (SMALL_MATRIX),
+       .K_SPLIT (K_SPLIT),
+       .GEMV (GEMV),
+       .PE_CLOCK_GATING (PE_CLOCK_GATING),
+       .BCAST_DEPTH (PE_BCAST_DEPTH),
+       .BCAST_FANOUT (PE_BCAST_FANOUT)
        )
    datapath_inst (
                   .clk                                (clk),
+                  .clk2x                              (clk2x),
                   .clr_n                              (rst_n), // Connect top-level reset to datapath reset
 
                   // Connected to the selection logic (driven by external or controller)
@@ -132,21 +277,37 @@ module top
                   .addr_a_brams_in                    (datapath_addr_a_brams),
                   .we_a_brams_in                      (datapath_we_a_brams),
                   .din_a_brams_in                     (datapath_din_a_brams),
+                  .a_pad_in                           (a_pad),
                   .en_b_brams_in                      (datapath_en_b_brams),
                   .addr_b_brams_in                    (datapath_addr_b_brams),
                   .we_b_brams_in                      (datapath_we_b_brams),
                   .din_b_brams_in                     (datapath_din_b_brams),
+                  .load_op_in                         (load_op),
+                  .ld_en_a_brams_in                   (ld_en_a_brams),
+                  .ld_addr_a_brams_in                 (addr_a_brams_in),
+                  .ld_we_a_brams_in                   (we_a_brams_in),
+                  .ld_din_a_brams_in                  (din_a_brams_in),
+                  .ld_en_b_brams_in                   (ld_en_b_brams),
+                  .ld_addr_b_brams_in                 (addr_b_brams_in),
+                  .ld_we_b_brams_in                   (we_b_brams_in),
+                  .ld_din_b_brams_in                  (din_b_brams_in),
 
 
                   // Connected to Controller Outputs  (Specific to Execution Flow)
                   .k_idx_in                           (k_idx_in),
+                  .pe_bit_idx_in                      (pe_bit_idx_in),
+                  .grp_idx_in                         (grp_idx_in),
                   .en_c_bram_in                       (en_c_bram_in),
                   .we_c_bram_in                       (we_c_bram_in),
                   .addr_c_bram_in                     (addr_c_bram_in),
                   .pe_write_idx_in                    (pe_write_idx_in),
+                  .c_op_in                            (c_op_in),
                   .pe_start_in                        (pe_start_in),
                   .pe_valid_in_in                     (pe_valid_in_in),
                   .pe_last_in                         (pe_last_in),
+                  .pe_row_en_in                       (pe_row_en),
+                  .pe_col_en_in                       (pe_col_en),
+                  .part_en_in                         (partition),
                   .pe_output_capture_en               (pe_output_capture_en),
                   .pe_output_buffer_reset             (pe_output_buffer_reset),
 
@@ -169,12 +330,60 @@ module top
        .N          (N),
        .N_BANKS    (N_BANKS),
        .PE_ROWS    (PE_ROWS),
-       .PE_COLS    (PE_COLS)
+       .PE_COLS    (PE_COLS),
+       .PE_PIPE_DEPTH (PE_PIPE_DEPTH),
+       .BCAST_DEPTH (PE_BCAST_DEPTH),
+       .BRAM_RD_LATENCY (BRAM_RD_LATENCY),
+       .SMALL_MATRIX (SMALL_MATRIX),
+       .K_SPLIT (K_SPLIT),
+       .GEMV (GEMV),
+       .BIT_SERIAL (PE_BIT_SERIAL),
+       .STRASSEN (STRASSEN),
+       .K_STALL (K_STALL),
+       .STREAM_K_SLOTS (STREAM_K_SLOTS),
+       .CONV (CONV),
+       .CONV_DIM_WIDTH (CONV_DIM_WIDTH),
+       .AGU (AGU),
+       .SKEW (SKEW),
+       .ROW_GROUPS (ROW_GROUPS),
+       .CONV_IFM_DEPTH (CONV_IFM_DEPTH),
+       .REGISTERED_OUTPUTS (CTRL_REGISTERED_OUTPUTS)
        )
    controller_inst (
                     .clk                             (clk),
                     .rst_n                           (rst_n), // Connect top-level reset to controller reset
                     .start_mult                      (start_mult), // Connect to top-level start signal
+                    .precision                       (precision),
+                    .c_targets                       (c_targets),
+                    .k_stall                         (operand_stall),
+                    .slice_valid                     (slice_valid),
+                    .slice_slot                      (slice_slot),
+                    .slice_free                      (slice_free),
+                    .transpose_a                     (transpose_a),
+                    .transpose_b                     (transpose_b),
+                    .agu_en                          (agu_en),
+                    .agu_a_base                      (agu_a_base),
+                    .agu_a_stride_r                  (agu_a_stride_r),
+                    .agu_a_stride_k                  (agu_a_stride_k),
+                    .agu_b_base                      (agu_b_base),
+                    .agu_b_stride_c                  (agu_b_stride_c),
+                    .agu_b_stride_k                  (agu_b_stride_k),
+                    .agu_c_base                      (agu_c_base),
+                    .agu_c_stride_r                  (agu_c_stride_r),
+                    .agu_c_stride_c                  (agu_c_stride_c),
+                    .agu_k_len                       (agu_k_len),
+                    .agu_m_len                       (agu_m_len),
+                    .agu_n_len                       (agu_n_len),
+                    .conv_en                         (conv_en),
+                    .conv_in_w                       (conv_in_w),
+                    .conv_in_h                       (conv_in_h),
+                    .conv_in_c                       (conv_in_c),
+                    .conv_kw                         (conv_kw),
+                    .conv_kh                         (conv_kh),
+                    .conv_stride                     (conv_stride),
+                    .conv_pad                        (conv_pad),
+                    .conv_ox                         (conv_ox),
+                    .conv_oy                         (conv_oy),
 
                     // Connected to Datapath Outputs (Internal Wires)
                     .pe_outputs_valid_out            (pe_outputs_valid_out),
@@ -182,9 +391,12 @@ module top
 
                     // Connected to Internal Wires   (Controller Outputs that feed the selection logic)
                     .k_idx_in                        (k_idx_in),
+                    .pe_bit_idx_in                   (pe_bit_idx_in),
+                    .grp_idx_in                      (grp_idx_in),
                     .en_a_brams_in                   (ctrl_en_a_brams), // Controller drives these wires
                     .addr_a_brams_in                 (ctrl_addr_a_brams), // Controller drives these wires
                     .we_a_brams_in                   (ctrl_we_a_brams), // Controller drives these wires
+                    .a_pad_in                        (a_pad),
                     .en_b_brams_in                   (ctrl_en_b_brams), // Controller drives these wires
                     .addr_b_brams_in                 (ctrl_addr_b_brams), // Controller drives these wires
                     .we_b_brams_in                   (ctrl_we_b_brams), // Controller drives these wires
@@ -192,9 +404,12 @@ module top
                     .we_c_bram_in                    (we_c_bram_in),
                     .addr_c_bram_in                  (addr_c_bram_in),
                     .pe_write_idx_in                 (pe_write_idx_in),
+                    .c_op_in                         (c_op_in),
                     .pe_start_in                     (pe_start_in),
                     .pe_valid_in_in                  (pe_valid_in_in),
                     .pe_last_in                      (pe_last_in),
+                    .pe_row_en                       (pe_row_en),
+                    .pe_col_en                       (pe_col_en),
                     .pe_output_capture_en            (pe_output_capture_en),
                     .pe_output_buffer_reset          (pe_output_buffer_reset),
 
@@ -202,4 +417,79 @@ module top
                     .mult_done                       (mult_done) // Connects directly to top-level output
                     );
 
+   // Configuration check: Strassen block mode uses Port B of every BRAM for its
+   // read-modify-write paths, and signed array-multiplier PEs.
+   generate
+      if (STRASSEN && (BRAM_OUT_REG || K_SPLIT > 1 || SMALL_MATRIX || PE_CSA_ACC || PE_MUL_BOOTH || PE_BIT_SERIAL))
+        begin : strassen_check_gen
+           initial
+             $fatal(1, "top: STRASSEN needs BRAM_OUT_REG = 0, K_SPLIT = 1, SMALL_MATRIX = 0 and array-multiplier PEs (no PE_CSA_ACC, PE_MUL_BOOTH or PE_BIT_SERIAL)");
+        end
+   endgenerate
+
+   // Configuration check: a double-pumped multiplier serves an even/odd column pair
+   // and has the plain unsigned array-multiplier pipeline.
+   generate
+      if (PE_DOUBLE_PUMP && (PE_COLS % 2 || PE_MUL_BOOTH || PE_CSA_ACC || PE_BIT_SERIAL || K_SPLIT > 1 || STRASSEN))
+        begin : double_pump_check_gen
+           initial
+             $fatal(1, "top: PE_DOUBLE_PUMP needs an even PE_COLS (%0d) and no PE_MUL_BOOTH, PE_CSA_ACC, PE_BIT_SERIAL, K_SPLIT or STRASSEN",
+                    PE_COLS);
+        end
+   endgenerate
+
+   // Configuration check: a K-loop stall holds the operands on the BRAM outputs,
+   // which the BRAM output register stage would still advance.
+   generate
+      if (K_STALL && BRAM_OUT_REG)
+        begin : k_stall_check_gen
+           initial
+             $fatal(1, "top: K_STALL needs BRAM_OUT_REG = 0");
+        end
+   endgenerate
+
+   // Configuration check: streaming K loads through Port B during the job and
+   // waits for slices with K_STALL bubbles.
+   generate
+      if (STREAM_K_SLOTS > 0 && (K_SPLIT > 1 || STRASSEN || LOAD_RATIO > 1 || BRAM_OUT_REG))
+        begin : stream_k_check_gen
+           initial
+             $fatal(1, "top: STREAM_K_SLOTS = %0d needs K_SPLIT = 1, STRASSEN = 0, LOAD_RATIO = 1 and BRAM_OUT_REG = 0",
+                    STREAM_K_SLOTS);
+        end
+   endgenerate
+
+   // Configuration check: skewed storage spreads each row and column of an operand
+   // over distinct banks, which needs M, N <= N_BANKS and whole diagonals along K.
+   generate
+      if (SKEW && (K % N_BANKS != 0 || M > N_BANKS || N > N_BANKS || SMALL_MATRIX || K_SPLIT > 1 || GEMV || STREAM_K_SLOTS > 0))
+        begin : skew_check_gen
+           initial
+             $fatal(1, "top: SKEW needs K (%0d) a multiple of N_BANKS (%0d), M (%0d) and N (%0d) <= N_BANKS, and no SMALL_MATRIX, K_SPLIT, GEMV or STREAM_K_SLOTS",
+                    K, N_BANKS, M, N);
+        end
+   endgenerate
+
+   // Configuration check: with M or N > N_BANKS (ROW_GROUPS > 1) only the plain GEMM
+   // schedule reads its operands one row group per cycle; reject the other modes.
+   generate
+      if (ROW_GROUPS > 1 && (SMALL_MATRIX || K_SPLIT > 1 || GEMV || PE_BIT_SERIAL || PE_PART_ROWS * PE_PART_COLS > 1 ||
+                             STREAM_K_SLOTS > 0 || CONV || AGU || SKEW))
+        begin : row_groups_check_gen
+           initial
+             $fatal(1, "top: ROW_GROUPS = %0d (M = %0d, N = %0d, N_BANKS = %0d) needs the plain GEMM schedule (no SMALL_MATRIX, K_SPLIT, GEMV, PE_BIT_SERIAL, partitioning, STREAM_K_SLOTS, CONV, AGU or SKEW)",
+                    ROW_GROUPS, M, N, N_BANKS);
+        end
+   endgenerate
+
+   // Configuration check: wide loads own Port B of the A/B banks, in power-of-2 words.
+   generate
+      if (LOAD_RATIO > 1 && ((LOAD_RATIO & (LOAD_RATIO - 1)) != 0 || K_SPLIT > 1 || STRASSEN || SMALL_MATRIX))
+        begin : load_ratio_check_gen
+           initial
+             $fatal(1, "top: LOAD_RATIO = %0d must be a power of 2 and needs K_SPLIT = 1, STRASSEN = 0 and SMALL_MATRIX = 0",
+                    LOAD_RATIO);
+        end
+   endgenerate
+
 endmodule
@@ -0,0 +1,311 @@
+//----------------------------------------------------------------------------
+// Testbench for avalon_multicore_wrapper
+// Loads and submits one job per core back to back (the second job is loaded
+// while the first one runs), reads C of every core and checks it against a
+// reference product, then releases the cores and runs a third job on the
+// reclaimed core 0.
+//----------------------------------------------------------------------------
+`timescale 1ns / 1ps
+
+module avalon_multicore_wrapper_tb;
+
+   // Parameters (must match the avalon_multicore_wrapper module)
+   parameter DATA_WIDTH = 16;
+   parameter M = 4;
+   parameter K = 4;
+   parameter N = 4;
+   parameter N_BANKS = 4;
+   parameter PE_ROWS = M;
+   parameter PE_COLS = N;
+   parameter N_CORES = 2;
+   parameter ID_WIDTH = 4; // For address lines (0-12 -> 4 bits)
+   parameter NUM_JOBS = 3; // Jobs 0 .. N_CORES-1 fill the cores, the rest reuse released ones
+
+   // Derived parameters (matching the wrapper)
+   parameter ADDR_WIDTH_A_BANK = ((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K) : 1;
+   parameter ADDR_WIDTH_B_BANK = (K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1;
+   parameter ADDR_WIDTH_A = $clog2(N_BANKS) + ADDR_WIDTH_A_BANK;
+   parameter ADDR_WIDTH_B = $clog2(N_BANKS) + ADDR_WIDTH_B_BANK;
+   parameter ACC_WIDTH = DATA_WIDTH * 2 + ((K > 1) ? $clog2(K) : 1);
+
+   // Testbench signals (corresponding to avalon_multicore_wrapper ports)
+   reg       clk;
+   reg       reset_n;
+   reg [ID_WIDTH-1:0] address;
+   reg                chipselect;
+   reg                read;
+   reg                write;
+   reg [N_BANKS * DATA_WIDTH - 1:0] writedata;
+   wire [ACC_WIDTH:0]               readdata;
+   wire                             waitrequest;
+   wire                             irq;
+
+   // Local parameters for address map
+   localparam                       ADDR_CONTROL = 4'd0;
+   localparam                       ADDR_STATUS = 4'd1;
+   localparam                       ADDR_C_ADDR = 4'd2;
+   localparam                       ADDR_C_DATA = 4'd3;
+   localparam                       ADDR_A_ADDR = 4'd4;
+   localparam                       ADDR_A_DATA = 4'd5;
+   localparam                       ADDR_B_ADDR = 4'd6;
+   localparam                       ADDR_B_DATA = 4'd7;
+   localparam                       ADDR_CAPS = 4'd8;
+   localparam                       ADDR_DONE_MASK = 4'd9;
+   localparam                       ADDR_READ_CORE = 4'd10;
+   localparam                       ADDR_STAGE_CORE = 4'd11;
+
+   // Operands and reference results of every job
+   reg [DATA_WIDTH-1:0]             job_A [0:NUM_JOBS-1][0:M-1][0:K-1];
+   reg [DATA_WIDTH-1:0]             job_B [0:NUM_JOBS-1][0:K-1][0:N-1];
+   reg [ACC_WIDTH-1:0]              job_C [0:NUM_JOBS-1][0:M-1][0:N-1];
+   integer                          job_core [0:NUM_JOBS-1]; // Core each job was staged on
+
+   integer                          job, i, j, k;
+   integer                          total_errors;
+
+   // Instantiate the avalon_multicore_wrapper
+   avalon_multicore_wrapper
+     #(
+       .DATA_WIDTH (DATA_WIDTH),
+       .M          (M),
+       .K          (K),
+       .N          (N),
+       .N_BANKS    (N_BANKS),
+       .PE_ROWS    (PE_ROWS),
+       .PE_COLS    (PE_COLS),
+       .N_CORES    (N_CORES),
+       .ID_WIDTH   (ID_WIDTH)
+       )
+   dut (
+        .clk          (clk),
+        .reset_n      (reset_n),
+        .address      (address),
+        .chipselect   (chipselect),
+        .read         (read),
+        .write        (write),
+        .writedata    (writedata),
+        .readdata     (readdata),
+        .waitrequest  (waitrequest),
+        .irq          (irq)
+        );
+
+
+   // Clock generation
+   initial begin
+      clk = 0;
+      forever #5 clk = ~clk; // 10ns period (100 MHz)
+   end
+
+   // Tasks for Avalon MM transactions
+   //----------------------------------------------------------------------------
+   task avalon_write;
+      input [ID_WIDTH-1:0] addr;
+      input [N_BANKS * DATA_WIDTH - 1:0] data;
+      begin
+         @(posedge clk); #1; // Drive just after the clock edge
+         chipselect = 1'b1;
+         write = 1'b1;
+         read = 1'b0;
+         address = addr;
+         writedata = data;
+         // Hold the transfer until the slave accepts it: waitrequest is
+         // sampled at the falling edge, the write happens on the next rising one
+         @(negedge clk);
+         while (waitrequest) @(negedge clk);
+         @(posedge clk); #1;
+         chipselect = 1'b0;
+         write = 1'b0;
+         address = 'b0;
+         writedata = 'b0;
+      end
+   endtask
+
+   task avalon_read;
+      input [ID_WIDTH-1:0] addr;
+      output [ACC_WIDTH:0] data;
+      begin
+         @(posedge clk); #1; // Drive just after the clock edge
+         chipselect = 1'b1;
+         read = 1'b1;
+         write = 1'b0;
+         address = addr;
+         // C reads: the BRAM samples the address on the first edge and readdata
+         // registers dout_c on the second one
+         @(posedge clk);
+         @(posedge clk); #1;
+         data = readdata;
+         chipselect = 1'b0;
+         read = 1'b0;
+         address = 'b0;
+      end
+   endtask
+   //----------------------------------------------------------------------------
+
+   // Load the operands of job 'jb' into the staging core and submit it
+   task load_and_submit;
+      input integer jb;
+      reg [ACC_WIDTH:0] stage;
+      reg [N_BANKS * ADDR_WIDTH_A - 1:0] a_addr;
+      reg [N_BANKS * ADDR_WIDTH_B - 1:0] b_addr;
+      reg [N_BANKS * DATA_WIDTH - 1:0]   row_data;
+      integer bank, kk;
+      begin
+         avalon_read(ADDR_STAGE_CORE, stage);
+         job_core[jb] = stage[((N_CORES > 1) ? $clog2(N_CORES) : 1)-1:0];
+         $display("Time %0t: Job %0d staged on core %0d (valid %b).", $time, jb, job_core[jb],
+                  stage[(N_CORES > 1) ? $clog2(N_CORES) : 1]);
+
+         // A[i][k] in bank i at address k, B[k][j] in bank j at address k (M = N = N_BANKS)
+         for (kk = 0; kk < K; kk = kk + 1)
+           begin
+              for (bank = 0; bank < N_BANKS; bank = bank + 1)
+                begin
+                   a_addr[bank * ADDR_WIDTH_A +: ADDR_WIDTH_A] = {bank[ADDR_WIDTH_A-ADDR_WIDTH_A_BANK-1:0], kk[ADDR_WIDTH_A_BANK-1:0]};
+                   row_data[bank * DATA_WIDTH +: DATA_WIDTH] = job_A[jb][bank][kk];
+                end
+              avalon_write(ADDR_A_ADDR, a_addr);
+              avalon_write(ADDR_A_DATA, row_data);
+
+              for (bank = 0; bank < N_BANKS; bank = bank + 1)
+                begin
+                   b_addr[bank * ADDR_WIDTH_B +: ADDR_WIDTH_B] = {bank[ADDR_WIDTH_B-ADDR_WIDTH_B_BANK-1:0], kk[ADDR_WIDTH_B_BANK-1:0]};
+                   row_data[bank * DATA_WIDTH +: DATA_WIDTH] = job_B[jb][kk][bank];
+                end
+              avalon_write(ADDR_B_ADDR, b_addr);
+              avalon_write(ADDR_B_DATA, row_data);
+           end
+
+         $display("Time %0t: Submitting job %0d.", $time, jb);
+         avalon_write(ADDR_CONTROL, 3); // bit 0 = submit, bit 1 = out of reset, full precision
+      end
+   endtask
+
+   // Read C of job 'jb' from its core and compare it with the reference
+   task check_job;
+      input integer jb;
+      reg [ACC_WIDTH:0] data;
+      integer row, col, errors;
+      begin
+         errors = 0;
+         avalon_write(ADDR_READ_CORE, job_core[jb]);
+         for (row = 0; row < M; row = row + 1)
+           for (col = 0; col < N; col = col + 1)
+             begin
+                avalon_write(ADDR_C_ADDR, row * N + col);
+                avalon_read(ADDR_C_DATA, data);
+                if (data[ACC_WIDTH-1:0] !== job_C[jb][row][col])
+                  begin
+                     $display("Job %0d (core %0d) FAIL: C[%0d][%0d] = %h, expected %h",
+                              jb, job_core[jb], row, col, data[ACC_WIDTH-1:0], job_C[jb][row][col]);
+                     errors = errors + 1;
+                  end
+             end
+         if (errors == 0)
+           $display("Time %0t: Job %0d (core %0d) PASS.", $time, jb, job_core[jb]);
+         total_errors = total_errors + errors;
+      end
+   endtask
+
+   // Poll the completion mask until every core in 'mask' holds a result
+   task wait_done;
+      input [N_CORES-1:0] mask;
+      reg [ACC_WIDTH:0] data;
+      integer polls;
+      begin
+         data = 'b0;
+         for (polls = 0; polls < 1000 && (data[N_CORES-1:0] & mask) != mask; polls = polls + 1)
+           avalon_read(ADDR_DONE_MASK, data);
+         if ((data[N_CORES-1:0] & mask) != mask)
+           begin
+              $display("Time %0t: FAIL: cores %b never completed (done mask %b).", $time, mask, data[N_CORES-1:0]);
+              total_errors = total_errors + 1;
+           end
+      end
+   endtask
+
+   // Test sequence
+   initial
+     begin : initial_blk
+        reg [ACC_WIDTH:0] temp_read_data;
+
+        $dumpfile("avalon_multicore_wrapper_tb.vcd");
+        $dumpvars(0, avalon_multicore_wrapper_tb);
+
+        // Random operands and reference products
+        for (job = 0; job < NUM_JOBS; job = job + 1)
+          begin
+             for (i = 0; i < M; i = i + 1)
+               for (k = 0; k < K; k = k + 1)
+                 job_A[job][i][k] = $random;
+             for (k = 0; k < K; k = k + 1)
+               for (j = 0; j < N; j = j + 1)
+                 job_B[job][k][j] = $random;
+             for (i = 0; i < M; i = i + 1)
+               for (j = 0; j < N; j = j + 1)
+                 begin
+                    job_C[job][i][j] = 0;
+                    for (k = 0; k < K; k = k + 1)
+                      job_C[job][i][j] = job_C[job][i][j] + job_A[job][i][k] * job_B[job][k][j];
+                 end
+          end
+
+        total_errors = 0;
+
+        // Initialize Avalon signals
+        chipselect = 1'b0;
+        read = 1'b0;
+        write = 1'b0;
+        address = 'b0;
+        writedata = 'b0;
+
+        // Apply reset
+        reset_n = 1'b0;
+        #40;
+        reset_n = 1'b1;
+        #40;
+
+        $display("--- Start Test Sequence ---");
+
+        avalon_read(ADDR_CAPS, temp_read_data);
+        $display("Time %0t: Capabilities: %0d cores, queue depth %0d.", $time, temp_read_data[7:0], temp_read_data[15:8]);
+
+        // One job per core; job 1 is loaded while job 0 runs
+        for (job = 0; job < N_CORES; job = job + 1)
+          load_and_submit(job);
+        for (job = 1; job < N_CORES; job = job + 1)
+          if (job_core[job] == job_core[0])
+            begin
+               $display("FAIL: jobs 0 and %0d were both staged on core %0d.", job, job_core[0]);
+               total_errors = total_errors + 1;
+            end
+
+        wait_done({N_CORES{1'b1}});
+        for (job = 0; job < N_CORES; job = job + 1)
+          check_job(job);
+
+        // Release every core (bit c of address 9) and run the remaining jobs
+        for (job = N_CORES; job < NUM_JOBS; job = job + 1)
+          begin
+             avalon_write(ADDR_DONE_MASK, {N_CORES{1'b1}});
+             load_and_submit(job);
+             wait_done(1 << job_core[job]);
+             check_job(job);
+          end
+
+        avalon_read(ADDR_STATUS, temp_read_data);
+        if (temp_read_data[0] !== 1'b1)
+          begin
+             $display("Time %0t: FAIL: status of the last job is %b, expected 1.", $time, temp_read_data[0]);
+             total_errors = total_errors + 1;
+          end
+
+        if (total_errors == 0)
+          $display("--- Testbench PASSED ---");
+        else
+          $display("--- Testbench FAILED with %0d errors ---", total_errors);
+
+        #100;
+        $finish;
+     end
+
+endmodule
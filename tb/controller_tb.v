@@ -15,10 +15,10 @@ module controller_tb;
 
    // Derived parameters (matching controller, used here for sizing)
    // Ensure dimensions are positive to avoid $clog2(0) issues
-   parameter ADDR_WIDTH_A = (($clog2(N_BANKS)) + ((M/N_BANKS * K > 0) ? $clog2(M/N_BANKS * K) : 1));
-   parameter ADDR_WIDTH_B = (($clog2(N_BANKS)) + ((K * N/N_BANKS > 0) ? $clog2(K * N/N_BANKS) : 1));
-   parameter ADDR_WIDTH_A_BANK = (M/N_BANKS * K > 0) ? $clog2(M/N_BANKS * K) : 1;
-   parameter ADDR_WIDTH_B_BANK = (K * N/N_BANKS > 0) ? $clog2(K * N/N_BANKS) : 1;
+   parameter ADDR_WIDTH_A = (($clog2(N_BANKS)) + (((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K) : 1));
+   parameter ADDR_WIDTH_B = (($clog2(N_BANKS)) + ((K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1));
+   parameter ADDR_WIDTH_A_BANK = ((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K) : 1;
+   parameter ADDR_WIDTH_B_BANK = (K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1;
    parameter ADDR_WIDTH_C = (M * N > 0) ? $clog2(M * N) : 1;
    parameter ACC_WIDTH_PE = DATA_WIDTH * 2 + ((K > 1) ? $clog2(K) : 1); // PE accumulator width must match
    parameter ADDR_WIDTH_BANK = $clog2(N_BANKS); // Width of the bank index in the new address format
@@ -31,11 +31,11 @@ module controller_tb;
    // Testbench Signals (Outputs from Controller - Declared as wires)
    wire [$clog2(K)-1:0] k_idx_in;
 
-   wire [N_BANKS * ($clog2(N_BANKS) + ((M/N_BANKS * K > 0) ? $clog2(M/N_BANKS * K) : 1)) - 1:0] addr_a_brams_in;
+   wire [N_BANKS * ($clog2(N_BANKS) + (((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K) : 1)) - 1:0] addr_a_brams_in;
    wire                                                                                         en_a_brams_in;
    wire                                                                                         we_a_brams_in;
    wire                                                                                         en_b_brams_in;
-   wire [N_BANKS * ($clog2(N_BANKS) + ((K * N/N_BANKS > 0) ? $clog2(K * N/N_BANKS) : 1)) - 1:0] addr_b_brams_in;
+   wire [N_BANKS * ($clog2(N_BANKS) + ((K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1)) - 1:0] addr_b_brams_in;
    wire                                                                                         we_b_brams_in;
    wire                                                                                         en_c_bram_in;
    wire                                                                                         we_c_bram_in;
@@ -50,7 +50,7 @@ module controller_tb;
 
    // Testbench Signals (Inputs to Controller simulating Datapath Status - Declared as regs)
    // We will manually control these signals in the testbench to simulate datapath behavior
-   reg [(PE_ROWS * PE_COLS)-1:0]            pe_outputs_valid_out_tb;
+   wire [(PE_ROWS * PE_COLS)-1:0]           pe_outputs_valid_out_tb;
    reg                                      pe_output_buffer_valid_out_tb;
 
 
@@ -70,6 +70,37 @@ module controller_tb;
                     .clk(clk),
                     .rst_n(rst_n),
                     .start_mult(start_mult),
+                    .precision(0), // Full precision (only used with BIT_SERIAL)
+                    .c_targets(8'b0), // Single C block (only used with STRASSEN)
+                    .k_stall(1'b0), // Operands always available (only used with K_STALL)
+                    .slice_valid(1'b0), // A/B fully resident (only used with STREAM_K_SLOTS)
+                    .slice_slot(0),
+                    .slice_free(),
+                    .transpose_a(1'b0), // Operands used as stored (only used with SKEW)
+                    .transpose_b(1'b0),
+                    .agu_en(1'b0), // Default addressing (only used with AGU)
+                    .agu_a_base(0),
+                    .agu_a_stride_r(0),
+                    .agu_a_stride_k(0),
+                    .agu_b_base(0),
+                    .agu_b_stride_c(0),
+                    .agu_b_stride_k(0),
+                    .agu_c_base(0),
+                    .agu_c_stride_r(0),
+                    .agu_c_stride_c(0),
+                    .agu_k_len(0),
+                    .agu_m_len(0),
+                    .agu_n_len(0),
+                    .conv_en(1'b0), // Plain GEMM jobs (only used with CONV)
+                    .conv_in_w(0),
+                    .conv_in_h(0),
+                    .conv_in_c(0),
+                    .conv_kw(4'd0),
+                    .conv_kh(4'd0),
+                    .conv_stride(3'd0),
+                    .conv_pad(3'd0),
+                    .conv_ox(0),
+                    .conv_oy(0),
 
                     // Connected to Testbench Regs simulating Datapath Status
                     .pe_outputs_valid_out(pe_outputs_valid_out_tb),
@@ -80,6 +111,7 @@ module controller_tb;
                     .en_a_brams_in(en_a_brams_in),
                     .addr_a_brams_in(addr_a_brams_in),
                     .we_a_brams_in(we_a_brams_in),
+                    .a_pad_in(),
                     .en_b_brams_in(en_b_brams_in),
                     .addr_b_brams_in(addr_b_brams_in),
                     .we_b_brams_in(we_b_brams_in),
@@ -99,6 +131,19 @@ module controller_tb;
    // This should match the PE module's PE_ACC_LATENCY parameter
    localparam PE_ACC_LATENCY = 3;
 
+   // PE pipeline model: output_valid follows pe_last_in by PE_ACC_LATENCY cycles
+   reg [PE_ACC_LATENCY-1:0] pe_last_pipe_tb;
+
+   always @(posedge clk or negedge rst_n)
+     begin
+        if (!rst_n)
+          pe_last_pipe_tb <= 'b0;
+        else
+          pe_last_pipe_tb <= {pe_last_pipe_tb, pe_last_in};
+     end
+
+   assign pe_outputs_valid_out_tb = {(PE_ROWS * PE_COLS){pe_last_pipe_tb[PE_ACC_LATENCY-1]}};
+
 
    //--------------------------------------------------------------------------
    // Testbench Tasks
@@ -154,12 +199,12 @@ module controller_tb;
    endtask
 
 
-   // Task to simulate PE outputs becoming valid
+   // Task to wait for the latency schedule to capture the PE outputs
    task simulate_pe_outputs_valid;
       begin
-         $display("@%0t: Simulating pe_outputs_valid_out going high...", $time);
-         pe_outputs_valid_out_tb = {(PE_ROWS * PE_COLS){1'b1}}; // Assert all PE output_valid flags high
-         @(posedge clk); #1; // Wait one clock cycle for controller to register valid outputs
+         $display("@%0t: Waiting for scheduled PE output capture...", $time);
+         wait (pe_output_capture_en); // Controller leaves WAIT_PE_DONE after PE_ACC_LATENCY cycles
+         @(posedge clk); #1; // Capture takes one clock cycle
       end
    endtask
 
@@ -177,7 +222,6 @@ module controller_tb;
            end
          // Simulate buffer valid going low after the last write
          pe_output_buffer_valid_out_tb = 0;
-         pe_outputs_valid_out_tb = 'b0; // Deassert PE valid signals after write
       end
    endtask
 
@@ -226,7 +270,6 @@ module controller_tb;
         clk = 0;
         rst_n = 0; // Start with reset asserted
         start_mult = 0;
-        pe_outputs_valid_out_tb = 'b0;
         pe_output_buffer_valid_out_tb = 0;
 
         // Wait for initial setup time
@@ -244,10 +287,7 @@ module controller_tb;
         // Simulate the K accumulation cycles + 1 cycle for state transition
         simulate_accumulation_phase(K);
 
-        // Simulate the PE pipeline latency before outputs become valid
-        simulate_pe_latency(PE_ACC_LATENCY + 2); // Add some margin
-
-        // Simulate the datapath signaling valid PE outputs
+        // Wait for the controller's latency schedule to capture the PE outputs
         simulate_pe_outputs_valid();
 
         // Simulate the M*N cycles required to write to the C BRAM
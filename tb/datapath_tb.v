@@ -29,15 +29,15 @@ module datapath_tb;
    parameter PE_COLS = N;
 
    // Derived Parameters (matching datapath)
-   parameter ADDR_WIDTH_A = $clog2(N_BANKS) + ((M/N_BANKS * K > 0) ? $clog2(M/N_BANKS * K) : 1);
-   parameter ADDR_WIDTH_B = $clog2(N_BANKS) + ((K * N/N_BANKS > 0) ? $clog2(K * N/N_BANKS) : 1);
+   parameter ADDR_WIDTH_A = $clog2(N_BANKS) + (((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K) : 1);
+   parameter ADDR_WIDTH_B = $clog2(N_BANKS) + ((K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1);
    parameter ADDR_WIDTH_C = (M * N > 0) ? $clog2(M * N) : 1;
    parameter ACC_WIDTH_PE = DATA_WIDTH * 2 + ((K > 1) ? $clog2(K) : 1);
    parameter N_PE = PE_ROWS * PE_COLS;
    parameter ADDR_WIDTH_PE_IDX = ($clog2(N_PE > 0 ? N_PE : 1) > 0) ? $clog2(N_PE > 0 ? N_PE : 1) : 1;
 
    parameter BANK_IDX_WIDTH = $clog2(N_BANKS);
-   parameter ADDR_IN_BANK_WIDTH = ((M/N_BANKS * K > 0) ? $clog2(M/N_BANKS * K) : 1);
+   parameter ADDR_IN_BANK_WIDTH = (((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K) : 1);
 
    // Clock Period
    parameter CLK_PERIOD = 10; // 10 ns period = 100 MHz
@@ -55,12 +55,12 @@ module datapath_tb;
    reg [$clog2(K > 0 ? K : 1)-1:0] k_idx_in;
 
    reg                             en_a_brams_in;
-   reg [N_BANKS * ($clog2(N_BANKS) + ((M/N_BANKS * K > 0) ? $clog2(M/N_BANKS * K) : 1)) - 1:0] addr_a_brams_in;
+   reg [N_BANKS * ($clog2(N_BANKS) + (((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K) : 1)) - 1:0] addr_a_brams_in;
    reg                                                                                         we_a_brams_in;
    reg [N_BANKS * DATA_WIDTH-1:0]                                                              din_a_brams_in;
 
    reg                                                                                         en_b_brams_in;
-   reg [N_BANKS * ($clog2(N_BANKS) + ((K * N/N_BANKS > 0) ? $clog2(K * N/N_BANKS) : 1)) - 1:0] addr_b_brams_in;
+   reg [N_BANKS * ($clog2(N_BANKS) + ((K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1)) - 1:0] addr_b_brams_in;
    reg                                                                                         we_b_brams_in;
    reg [N_BANKS * DATA_WIDTH-1:0]                                                              din_b_brams_in;
 
@@ -123,24 +123,41 @@ module datapath_tb;
    datapath #(.DATA_WIDTH (DATA_WIDTH), .M (M), .K (K), .N (N), .N_BANKS (N_BANKS), .PE_ROWS (PE_ROWS), .PE_COLS (PE_COLS))
    uut (
         .clk                        (clk),
+        .clk2x                      (1'b0), // PE_DOUBLE_PUMP off
         .clr_n                      (clr_n),
 
         .k_idx_in                   (k_idx_in),
+        .pe_bit_idx_in              (0),
+        .grp_idx_in                 (0),
         .en_a_brams_in              (en_a_brams_in),
         .addr_a_brams_in            (addr_a_brams_in),
         .we_a_brams_in              (we_a_brams_in),
         .din_a_brams_in             (din_a_brams_in),
+        .a_pad_in                   (0), // No padding reads (only used with CONV)
         .en_b_brams_in              (en_b_brams_in),
         .addr_b_brams_in            (addr_b_brams_in),
         .we_b_brams_in              (we_b_brams_in),
         .din_b_brams_in             (din_b_brams_in),
+        .load_op_in                 (2'b0),
+        .ld_en_a_brams_in           (1'b0), // No streaming loader (STREAM_K off)
+        .ld_addr_a_brams_in         (0),
+        .ld_we_a_brams_in           (1'b0),
+        .ld_din_a_brams_in          (0),
+        .ld_en_b_brams_in           (1'b0),
+        .ld_addr_b_brams_in         (0),
+        .ld_we_b_brams_in           (1'b0),
+        .ld_din_b_brams_in          (0),
         .en_c_bram_in               (en_c_bram_in),
         .we_c_bram_in               (we_c_bram_in),
         .addr_c_bram_in             (addr_c_bram_in),
         .pe_write_idx_in            (pe_write_idx_in),
+        .c_op_in                    (2'b0),
         .pe_start_in                (pe_start_in),
         .pe_valid_in_in             (pe_valid_in_in),
         .pe_last_in                 (pe_last_in),
+        .pe_row_en_in               ({PE_ROWS{1'b1}}),
+        .pe_col_en_in               ({PE_COLS{1'b1}}),
+        .part_en_in                 (1'b0),
         .pe_output_capture_en       (pe_output_capture_en),
         .pe_output_buffer_reset     (pe_output_buffer_reset),
 
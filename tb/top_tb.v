@@ -3,41 +3,114 @@
 // Description: Testbench for the matrix_multiplier_top module.
 //              Loads matrices using the shared Port A, triggers the
 //              multiplication, and verifies results.
+//
+// Configurations (CONFIG, e.g. vsim -gCONFIG="CSA_ACC" top_tb):
+//   "FILES"         : test cases read from TEST_CASE_DIR_BASE, default core
+//   Every other configuration runs NUM_GEN_CASES random cases and checks each
+//   C word against a reference computed here:
+//   "GEMM"          : default core
+//   "COMB_CTRL"     : controller outputs decoded combinationally (CTRL_REGISTERED_OUTPUTS = 0)
+//   "BCAST"         : PE controls/operands through register trees (PE_BCAST_PIPELINE = 1, fanout 2)
+//   "CSA_ACC"       : carry-save PE accumulators (PE_CSA_ACC = 1)
+//   "KS_ADDER"      : Kogge-Stone PE multiplier final adder (PE_MUL_FINAL_ADDER = 1)
+//   "BK_ADDER"      : Brent-Kung final adder (PE_MUL_FINAL_ADDER = 2)
+//   "HC_ADDER"      : Han-Carlson final adder (PE_MUL_FINAL_ADDER = 3)
+//   "BOOTH"         : radix-4 Booth PE multipliers with shared row recoding (PE_MUL_BOOTH = 1)
+//   "BOOTH_CSA"     : Booth multipliers feeding carry-save accumulators (PE_MUL_BOOTH = PE_CSA_ACC = 1)
+//   "NO_DATA_RESET" : no reset on the pure data registers (DATA_RESET = 0)
+//   "BRAM_OUT_REG"  : A/B BRAM output registers, read latency 2 (BRAM_OUT_REG = 1)
+//   "CLOCK_GATING"  : PE clock enables by job row/column and phase (PE_CLOCK_GATING = 1)
+//   "SMALL_MATRIX"  : register-file operands, C read from the PEs (SMALL_MATRIX = 1)
+//   "K_SPLIT"       : two PE planes each accumulate half of K (K_SPLIT = 2)
+//   "GEMV"          : y = A x on a 2x2 array of dot-product lanes, x in B bank 0 (GEMV = 1, N = 1)
+//   "BIT_SERIAL"    : bit-serial PEs; odd cases use 8-bit B and precision = 8 (PE_BIT_SERIAL = 1)
+//   "PARTITION"     : 2x2 PE regions, 8 banks; even cases run a batch of four 2x2 jobs (PE_PART_ROWS = PE_PART_COLS = 2)
+//   "STRASSEN"      : seven-product Strassen sequence on 2x2 blocks, signed (STRASSEN = 1)
+//   "DOUBLE_PUMP"   : one clk2x multiplier per two PE columns (PE_DOUBLE_PUMP = 1)
+//   "K_STALL"       : random operand stalls pause the K loop while a job runs (K_STALL = 1)
+//   "STREAM_K"      : A/B k-slices streamed into two bank slots while the job runs (STREAM_K_SLOTS = 2)
+//   "CONV"          : 2x2 convolution over a padded 2x4x4 feature map, K = 8 (CONV = 1, CONV_IFM_DEPTH = 24)
+//   "AGU"           : a default job, then a strided half-K job writing a transposed 3x2 corner of C (AGU = 1)
+//   "SKEW"          : diagonal A/B storage, one job per transpose_a/transpose_b setting (SKEW = 1)
+//   "ROW_GROUPS"    : 3x3x3 on 2 banks, two row groups per K step, partly used last group (N_BANKS = 2)
+//   "LOAD_RATIO"    : A/B images loaded two words per bank per access through the wide port (LOAD_RATIO = 2)
 //----------------------------------------------------------------------------
 `timescale 1ns/1ps
 module top_tb;
 
+   // Test configuration (see header)
+   parameter CONFIG = "FILES";
+
    // Parameters - Must match the top-level module instantiation
    parameter DATA_WIDTH = 16; // Data width of matrix elements A and B
-   parameter M = 4;           // Number of rows in Matrix A and C
-   parameter K = 4;           // Number of columns in Matrix A and rows in Matrix B
-   parameter N = 4;           // Number of columns in Matrix B and C
-   parameter N_BANKS = 4;     // Number of BRAM banks for Matrix A and B
+   parameter M = (CONFIG == "ROW_GROUPS") ? 3 : 4; // Number of rows in Matrix A and C
+   parameter K = (CONFIG == "CONV") ? 8 : (CONFIG == "ROW_GROUPS") ? 3 : 4; // Number of columns in Matrix A and rows in Matrix B (CONV: C*kh*kw)
+   parameter N = (CONFIG == "GEMV") ? 1 : (CONFIG == "ROW_GROUPS") ? 3 : 4; // Number of columns in Matrix B and C
+   parameter N_BANKS = (CONFIG == "PARTITION") ? 8 : (CONFIG == "ROW_GROUPS") ? 2 : 4; // Number of BRAM banks for Matrix A and B
+   parameter CONV_IFM_DEPTH = (CONFIG == "CONV") ? 24 : 0; // A bank words added for the CONV input feature map
 
    // Parameters for the 2D PE Array dimensions (Must match top-level module)
-   parameter PE_ROWS = M;     // Number of PE rows = M
-   parameter PE_COLS = N;     // Number of PE columns = N
+   parameter PE_ROWS = (CONFIG == "GEMV") ? 2 : M; // Number of PE rows = M (GEMV: lanes = PE_ROWS * PE_COLS)
+   parameter PE_COLS = (CONFIG == "GEMV") ? 2 : N; // Number of PE columns = N
    parameter N_PE = PE_ROWS * PE_COLS; // Total number of PEs
 
    // Derived parameters (matching top-level module, used here for sizing)
    // Ensure dimensions are positive to avoid $clog2(0) issues
-   parameter ADDR_WIDTH_A = ($clog2(N_BANKS) + ((M/N_BANKS * K > 0) ? $clog2(M/N_BANKS * K) : 1));
-   parameter ADDR_WIDTH_B = ($clog2(N_BANKS) + ((K * N/N_BANKS > 0) ? $clog2(K * N/N_BANKS) : 1));
-   parameter ADDR_WIDTH_A_BANK = (M/N_BANKS * K > 0) ? $clog2(M/N_BANKS * K) : 1;
-   parameter ADDR_WIDTH_B_BANK = (K * N/N_BANKS > 0) ? $clog2(K * N/N_BANKS) : 1;
-   parameter ADDR_WIDTH_C = (M * N > 0) ? $clog2(M * N) : 1;
+   parameter ADDR_WIDTH_A = ($clog2(N_BANKS) + (((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K + CONV_IFM_DEPTH) : 1));
+   parameter ADDR_WIDTH_B = ($clog2(N_BANKS) + ((K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1));
+   parameter ADDR_WIDTH_A_BANK = ((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K + CONV_IFM_DEPTH) : 1;
+   parameter ADDR_WIDTH_B_BANK = (K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1;
+   parameter ADDR_WIDTH_C = (M * N > 0) ? $clog2(M * N * ((CONFIG == "STRASSEN") ? 4 : 1)) : 1;
    // Accumulator width: DATA_WIDTH*2 for product + $clog2(K) for K additions
    parameter ADDR_WIDTH_BANK = $clog2(N_BANKS);
    parameter ACC_WIDTH = DATA_WIDTH * 2 + ((K > 1) ? $clog2(K) : 1);
 
    // Calculated Sizes for BRAMs and Matrices (matching datapath)
-   parameter A_BANK_SIZE = (M/N_BANKS) * K; // Size of each A BRAM bank
-   parameter B_BANK_SIZE = K * (N/N_BANKS); // Size of each B BRAM bank
+   parameter A_BANK_SIZE = ((M+N_BANKS-1)/N_BANKS) * K; // Size of each A BRAM bank
+   parameter B_BANK_SIZE = K * ((N+N_BANKS-1)/N_BANKS); // Size of each B BRAM bank
    parameter C_BRAM_SIZE = M * N;           // Size of the C BRAM
+   parameter A_BANK_DEPTH = 1 << ADDR_WIDTH_A_BANK; // Words addressable in each A bank
+   parameter B_BANK_DEPTH = 1 << ADDR_WIDTH_B_BANK; // Words addressable in each B bank
+
+   // Core options selected by CONFIG
+   parameter CTRL_REGISTERED_OUTPUTS = (CONFIG == "COMB_CTRL") ? 0 : 1;
+   parameter PE_BCAST_PIPELINE = (CONFIG == "BCAST") ? 1 : 0;
+   parameter PE_BCAST_FANOUT = (CONFIG == "BCAST") ? 2 : 4;
+   parameter PE_CSA_ACC = (CONFIG == "CSA_ACC" || CONFIG == "BOOTH_CSA") ? 1 : 0;
+   parameter PE_MUL_FINAL_ADDER = (CONFIG == "KS_ADDER") ? 1 : (CONFIG == "BK_ADDER") ? 2 : (CONFIG == "HC_ADDER") ? 3 : 0;
+   parameter PE_MUL_BOOTH = (CONFIG == "BOOTH" || CONFIG == "BOOTH_CSA") ? 1 : 0;
+   parameter DATA_RESET = (CONFIG == "NO_DATA_RESET") ? 0 : 1;
+   parameter BRAM_OUT_REG = (CONFIG == "BRAM_OUT_REG") ? 1 : 0;
+   parameter PE_CLOCK_GATING = (CONFIG == "CLOCK_GATING") ? 1 : 0;
+   parameter SMALL_MATRIX = (CONFIG == "SMALL_MATRIX") ? 1 : 0;
+   parameter K_SPLIT = (CONFIG == "K_SPLIT") ? 2 : 1;
+   parameter GEMV = (CONFIG == "GEMV") ? 1 : 0;
+   parameter PE_BIT_SERIAL = (CONFIG == "BIT_SERIAL") ? 1 : 0;
+   parameter PE_PART_ROWS = (CONFIG == "PARTITION") ? 2 : 1;
+   parameter PE_PART_COLS = (CONFIG == "PARTITION") ? 2 : 1;
+   parameter STRASSEN = (CONFIG == "STRASSEN") ? 1 : 0;
+   parameter PE_DOUBLE_PUMP = (CONFIG == "DOUBLE_PUMP") ? 1 : 0;
+   parameter K_STALL = (CONFIG == "K_STALL") ? 1 : 0;
+   parameter STREAM_K_SLOTS = (CONFIG == "STREAM_K") ? 2 : 0;
+   parameter CONV = (CONFIG == "CONV") ? 1 : 0;
+   parameter AGU = (CONFIG == "AGU") ? 1 : 0;
+   parameter SKEW = (CONFIG == "SKEW") ? 1 : 0;
+   parameter LOAD_RATIO = (CONFIG == "LOAD_RATIO") ? 2 : 1;
+   parameter PART_R_SIZE = PE_ROWS / PE_PART_ROWS; // PE rows per region
+   parameter PART_C_SIZE = PE_COLS / PE_PART_COLS; // PE columns per region
+   // CONV jobs: C x H x W input feature map, kh x kw kernels (C * kh * kw = K)
+   parameter CONV_C = 2;
+   parameter CONV_H = 4;
+   parameter CONV_W = 4;
+   parameter CONV_KH = 2;
+   parameter CONV_KW = 2;
+   parameter CONV_STRIDE = 1;
+   parameter CONV_PAD = 1;
 
 
    // Testbench Control Parameters
-   parameter NUM_TEST_CASES = 100; // How many test case directories to read (test_000 to test_099)
+   parameter NUM_TEST_CASES = (CONFIG == "FILES") ? 100 : 0; // How many test case directories to read (test_000 to test_099)
+   parameter NUM_GEN_CASES = (CONFIG == "FILES") ? 0 : 4;    // How many random test cases to generate
    // !! IMPORTANT: Update this path to where your test case directories are located !!
    // Use a reg array for the base path
    parameter [8*100-1:0] TEST_CASE_DIR_BASE = "/home/lamar/Documents/git/matrix-multiplier/testcases"; // Base directory for test cases (Max 100 chars)
@@ -46,18 +119,39 @@ module top_tb;
 
    // Testbench Signals (Inputs to Top Module - Declared as regs)
    reg                   clk;         // Clock signal
+   reg                   clk2x;       // 2x clock, rising edges aligned with clk (PE_DOUBLE_PUMP)
    reg                   rst_n;       // Asynchronous active-low reset
    reg                   start_mult;  // Start signal to initiate multiplication
+   reg [$clog2(DATA_WIDTH+1)-1:0] precision; // PE_BIT_SERIAL: B bits per element (0 = DATA_WIDTH)
+   reg                   partition;   // PE_PART_ROWS/COLS: run a batch of jobs, one per PE region
+   reg [1:0]             load_op;     // STRASSEN: 0/1 write, 2 add to, 3 subtract from the stored value
+   reg [7:0]             c_targets;   // STRASSEN: per C block, 0 skip, 1 write, 2 add, 3 subtract
+   reg                   operand_stall; // K_STALL: random K-loop bubbles while a job runs
+   reg                   slice_valid; // STREAM_K_SLOTS: the slice in slot 'slice_slot' has been written
+   reg [((K > 1) ? $clog2(K) : 1)-1:0] slice_slot;
+   wire [((STREAM_K_SLOTS > 0) ? STREAM_K_SLOTS : 1)-1:0] slice_free; // STREAM_K_SLOTS: slots that may be written
+   reg                   conv_en;     // CONV: the next job is a convolution
+   reg [7:0]             conv_ox;     // CONV: output column of PE row 0
+   reg [7:0]             conv_oy;     // CONV: output row of the job
+   reg                   agu_en;      // AGU: the next job uses the agu_* addressing
+   reg [ADDR_WIDTH_A_BANK-1:0] agu_a_base, agu_a_stride_r, agu_a_stride_k; // AGU: A view
+   reg [ADDR_WIDTH_B_BANK-1:0] agu_b_base, agu_b_stride_c, agu_b_stride_k; // AGU: B view
+   reg [ADDR_WIDTH_C-1:0]      agu_c_base, agu_c_stride_r, agu_c_stride_c; // AGU: C placement
+   reg [$clog2(K):0]           agu_k_len;   // AGU: K steps (0 = K)
+   reg [$clog2(M+1)-1:0]       agu_m_len;   // AGU: C rows written (0 = M)
+   reg [$clog2(N+1)-1:0]       agu_n_len;   // AGU: C columns written (0 = N)
+   reg                   transpose_a; // SKEW: the next job uses the transpose of the stored A
+   reg                   transpose_b; // SKEW: the next job uses the transpose of the stored B
 
    reg                   en_a_brams_in;
-   reg [N_BANKS * ($clog2(N_BANKS) + ((M/N_BANKS * K > 0) ? $clog2(M/N_BANKS * K) : 1)) - 1:0] addr_a_brams_in;
+   reg [N_BANKS * ($clog2(N_BANKS) + (((M+N_BANKS-1)/N_BANKS * K > 0) ? $clog2((M+N_BANKS-1)/N_BANKS * K + CONV_IFM_DEPTH) : 1)) - 1:0] addr_a_brams_in;
    reg                                                                                         we_a_brams_in;
-   reg [N_BANKS * DATA_WIDTH - 1:0]                                                            din_a_brams_in;
+   reg [N_BANKS * DATA_WIDTH * LOAD_RATIO - 1:0]                                               din_a_brams_in;
 
    reg                                                                                         en_b_brams_in;
-   reg [N_BANKS * ($clog2(N_BANKS) + ((K * N/N_BANKS > 0) ? $clog2(K * N/N_BANKS) : 1)) - 1:0] addr_b_brams_in;
+   reg [N_BANKS * ($clog2(N_BANKS) + ((K * ((N+N_BANKS-1)/N_BANKS) > 0) ? $clog2(K * ((N+N_BANKS-1)/N_BANKS)) : 1)) - 1:0] addr_b_brams_in;
    reg                                                                                         we_b_brams_in;
-   reg [N_BANKS * DATA_WIDTH - 1:0]                                                            din_b_brams_in;
+   reg [N_BANKS * DATA_WIDTH * LOAD_RATIO - 1:0]                                               din_b_brams_in;
    // Data input for writing to B banks (Port A)
 
 
@@ -88,6 +182,18 @@ module top_tb;
    reg [DATA_WIDTH-1:0]                    testbench_A [0:M-1][0:K-1];
    reg [DATA_WIDTH-1:0]                    testbench_B [0:K-1][0:N-1];
 
+   // Generated cases: A/B bank images (bank * depth + address) and expected C by C address
+   reg [DATA_WIDTH-1:0]                    a_image [0:N_BANKS*A_BANK_DEPTH-1];
+   reg [DATA_WIDTH-1:0]                    b_image [0:N_BANKS*B_BANK_DEPTH-1];
+   reg [ACC_WIDTH-1:0]                     expected_c_mem [0:(1<<ADDR_WIDTH_C)-1];
+
+   // CONV cases: the input feature map, pixel (c, y, x) at (c * H + y) * W + x
+   reg [DATA_WIDTH-1:0]                    conv_ifm [0:CONV_C*CONV_H*CONV_W-1];
+
+   // Strassen cases: the full 2M x 2K and 2K x 2N operands
+   reg [DATA_WIDTH-1:0]                    strassen_A [0:2*M-1][0:2*K-1];
+   reg [DATA_WIDTH-1:0]                    strassen_B [0:2*K-1][0:2*N-1];
+
    // Internal variables for loops and test counters
    integer                                 i, j, k; // Loop variables
    integer                                 test_case; // Current test case number (0 to NUM_TEST_CASES-1)
@@ -98,22 +204,85 @@ module top_tb;
 
    // Clock Generation
    always #5 clk = ~clk; // 10ns clock period (adjust as needed)
+   always #2.5 clk2x = ~clk2x; // Starts high, so it rises with every clk rising edge
+
+   // K_STALL: stall about half the cycles of a job, stable around the rising edge
+   always @(negedge clk)
+     operand_stall = K_STALL && start_mult && ($random & 1);
 
    // Instantiate the Top-Level Matrix Multiplier module
    top
      #(
-       .DATA_WIDTH (DATA_WIDTH),
-       .M          (M),
-       .K          (K),
-       .N          (N),
-       .N_BANKS    (N_BANKS),
-       .PE_ROWS    (PE_ROWS),
-       .PE_COLS    (PE_COLS)
+       .DATA_WIDTH              (DATA_WIDTH),
+       .M                       (M),
+       .K                       (K),
+       .N                       (N),
+       .N_BANKS                 (N_BANKS),
+       .PE_ROWS                 (PE_ROWS),
+       .PE_COLS                 (PE_COLS),
+       .CTRL_REGISTERED_OUTPUTS (CTRL_REGISTERED_OUTPUTS),
+       .PE_BCAST_PIPELINE       (PE_BCAST_PIPELINE),
+       .PE_BCAST_FANOUT         (PE_BCAST_FANOUT),
+       .PE_CSA_ACC              (PE_CSA_ACC),
+       .PE_MUL_FINAL_ADDER      (PE_MUL_FINAL_ADDER),
+       .PE_MUL_BOOTH            (PE_MUL_BOOTH),
+       .DATA_RESET              (DATA_RESET),
+       .BRAM_OUT_REG            (BRAM_OUT_REG),
+       .PE_CLOCK_GATING         (PE_CLOCK_GATING),
+       .SMALL_MATRIX            (SMALL_MATRIX),
+       .K_SPLIT                 (K_SPLIT),
+       .GEMV                    (GEMV),
+       .PE_BIT_SERIAL           (PE_BIT_SERIAL),
+       .PE_PART_ROWS            (PE_PART_ROWS),
+       .PE_PART_COLS            (PE_PART_COLS),
+       .STRASSEN                (STRASSEN),
+       .PE_DOUBLE_PUMP          (PE_DOUBLE_PUMP),
+       .K_STALL                 (K_STALL),
+       .STREAM_K_SLOTS          (STREAM_K_SLOTS),
+       .CONV                    (CONV),
+       .CONV_IFM_DEPTH          (CONV_IFM_DEPTH),
+       .AGU                     (AGU),
+       .SKEW                    (SKEW),
+       .LOAD_RATIO              (LOAD_RATIO)
        )
    dut (
         .clk                                                    (clk),
+        .clk2x                                                  (clk2x), // PE_DOUBLE_PUMP multiplier clock
         .rst_n                                                  (rst_n),
         .start_mult                                             (start_mult),
+        .precision                                              (precision), // B bits per element (only used with PE_BIT_SERIAL)
+        .partition                                              (partition), // Batch of jobs, one per PE region
+        .load_op                                                (load_op), // A/B load operation (STRASSEN)
+        .c_targets                                              (c_targets), // C blocks of the job (STRASSEN)
+        .operand_stall                                          (operand_stall), // K_STALL bubbles
+        .slice_valid                                            (slice_valid), // STREAM_K_SLOTS slice loader
+        .slice_slot                                             (slice_slot),
+        .slice_free                                             (slice_free),
+        .transpose_a                                            (transpose_a), // SKEW transpose flags
+        .transpose_b                                            (transpose_b),
+        .agu_en                                                 (agu_en), // AGU job addressing
+        .agu_a_base                                             (agu_a_base),
+        .agu_a_stride_r                                         (agu_a_stride_r),
+        .agu_a_stride_k                                         (agu_a_stride_k),
+        .agu_b_base                                             (agu_b_base),
+        .agu_b_stride_c                                         (agu_b_stride_c),
+        .agu_b_stride_k                                         (agu_b_stride_k),
+        .agu_c_base                                             (agu_c_base),
+        .agu_c_stride_r                                         (agu_c_stride_r),
+        .agu_c_stride_c                                         (agu_c_stride_c),
+        .agu_k_len                                              (agu_k_len),
+        .agu_m_len                                              (agu_m_len),
+        .agu_n_len                                              (agu_n_len),
+        .conv_en                                                (conv_en), // CONV job geometry
+        .conv_in_w                                              (CONV_W[7:0]),
+        .conv_in_h                                              (CONV_H[7:0]),
+        .conv_in_c                                              (CONV_C[7:0]),
+        .conv_kw                                                (CONV_KW[3:0]),
+        .conv_kh                                                (CONV_KH[3:0]),
+        .conv_stride                                            (CONV_STRIDE[2:0]),
+        .conv_pad                                               (CONV_PAD[2:0]),
+        .conv_ox                                                (conv_ox),
+        .conv_oy                                                (conv_oy),
         .mult_done                                              (mult_done),
 
         // **Connected to Testbench BRAM Load/Execution Signals (Port A)**
@@ -393,7 +562,7 @@ module top_tb;
                bank_a_idx = matrix_row % N_BANKS;
                addr_a = (matrix_row / N_BANKS) * K + matrix_col;
 
-               if (addr_a < (M/N_BANKS * K)) begin // Check bounds
+               if (addr_a < ((M+N_BANKS-1)/N_BANKS * K)) begin // Check bounds
                   // Drive the shared Port A read signals
                   en_a_brams_in[bank_a_idx] = 1;
                   addr_a_brams_in[(bank_a_idx * ADDR_WIDTH_A_BANK) +: ADDR_WIDTH_A_BANK] = addr_a;
@@ -429,9 +598,9 @@ module top_tb;
          for (matrix_row = 0; matrix_row < K; matrix_row = matrix_row + 1) begin // Matrix B has K rows
             for (matrix_col = 0; matrix_col < N; matrix_col = matrix_col + 1) begin // Matrix col has N columns
                bank_b_idx = matrix_col % N_BANKS;
-               addr_b = matrix_row * (N / N_BANKS) + matrix_col / N_BANKS;
+               addr_b = matrix_row * ((N+N_BANKS-1)/N_BANKS) + matrix_col / N_BANKS;
 
-               if (addr_b < (K * N/N_BANKS)) begin // Check bounds
+               if (addr_b < (K * ((N+N_BANKS-1)/N_BANKS))) begin // Check bounds
                   // Drive the shared Port A read signals
                   en_b_brams_in[bank_b_idx] = 1;
                   addr_b_brams_in[(bank_b_idx * ADDR_WIDTH_B_BANK)+:ADDR_WIDTH_B_BANK] = addr_b;
@@ -548,6 +717,507 @@ module top_tb;
    endtask
 
 
+   // --------------------------------------------------------------------------
+   // Generated cases
+   // --------------------------------------------------------------------------
+
+   // Random A and B operands (bit-serial PEs: odd cases use 8-bit B at precision 8)
+   task generate_operands;
+      begin : generate_operands
+         integer r, c;
+         precision = (PE_BIT_SERIAL && test_case % 2) ? 8 : 0;
+         for (r = 0; r < M; r = r + 1)
+           for (c = 0; c < K; c = c + 1)
+             testbench_A[r][c] = $random;
+         for (r = 0; r < K; r = r + 1)
+           for (c = 0; c < N; c = c + 1)
+             testbench_B[r][c] = (precision == 0) ? $random : $random & ((1 << precision) - 1);
+      end
+   endtask
+
+   // Expected C = A * B, C[i][j] at C address i * N + j
+   task compute_expected_gemm;
+      begin : compute_expected_gemm
+         integer r, c, kk;
+         for (r = 0; r < M; r = r + 1)
+           for (c = 0; c < N; c = c + 1)
+             begin
+                expected_c_mem[r * N + c] = 0;
+                for (kk = 0; kk < K; kk = kk + 1)
+                  expected_c_mem[r * N + c] = expected_c_mem[r * N + c] + testbench_A[r][kk] * testbench_B[kk][c];
+             end
+      end
+   endtask
+
+   // Zero every A and B bank word
+   task clear_images;
+      begin : clear_images
+         integer w;
+         for (w = 0; w < N_BANKS * A_BANK_DEPTH; w = w + 1)
+           a_image[w] = 0;
+         for (w = 0; w < N_BANKS * B_BANK_DEPTH; w = w + 1)
+           b_image[w] = 0;
+      end
+   endtask
+
+   // Bank images of A and B in the default layout:
+   // A[i][k] in bank i % N_BANKS at address (i / N_BANKS) * K + k,
+   // B[k][j] in bank j % N_BANKS at address k * ceil(N / N_BANKS) + j / N_BANKS
+   task pack_operands;
+      begin : pack_operands
+         integer r, c;
+         clear_images();
+         for (r = 0; r < M; r = r + 1)
+           for (c = 0; c < K; c = c + 1)
+             a_image[(r % N_BANKS) * A_BANK_DEPTH + (r / N_BANKS) * K + c] = testbench_A[r][c];
+         for (r = 0; r < K; r = r + 1)
+           for (c = 0; c < N; c = c + 1)
+             b_image[(c % N_BANKS) * B_BANK_DEPTH + r * ((N+N_BANKS-1)/N_BANKS) + c / N_BANKS] = testbench_B[r][c];
+      end
+   endtask
+
+   // Partitioned batch: job g = region_row * PE_PART_COLS + region_col multiplies a
+   // PART_R_SIZE x K by a K x PART_C_SIZE matrix. Row i of its A is in bank
+   // g * PART_R_SIZE + i and column j of its B in bank g * PART_C_SIZE + j, both at
+   // address k; C[i][j] of job g is at g * PART_R_SIZE * PART_C_SIZE + i * PART_C_SIZE + j.
+   task pack_partitioned_batch;
+      begin : pack_partitioned_batch
+         integer g, i, j, kk, c_addr;
+         clear_images();
+         for (g = 0; g < PE_PART_ROWS * PE_PART_COLS; g = g + 1)
+           begin
+              for (i = 0; i < PART_R_SIZE; i = i + 1)
+                for (kk = 0; kk < K; kk = kk + 1)
+                  a_image[(g * PART_R_SIZE + i) * A_BANK_DEPTH + kk] = $random;
+              for (j = 0; j < PART_C_SIZE; j = j + 1)
+                for (kk = 0; kk < K; kk = kk + 1)
+                  b_image[(g * PART_C_SIZE + j) * B_BANK_DEPTH + kk] = $random;
+              for (i = 0; i < PART_R_SIZE; i = i + 1)
+                for (j = 0; j < PART_C_SIZE; j = j + 1)
+                  begin
+                     c_addr = g * PART_R_SIZE * PART_C_SIZE + i * PART_C_SIZE + j;
+                     expected_c_mem[c_addr] = 0;
+                     for (kk = 0; kk < K; kk = kk + 1)
+                       expected_c_mem[c_addr] = expected_c_mem[c_addr] +
+                                                a_image[(g * PART_R_SIZE + i) * A_BANK_DEPTH + kk] *
+                                                b_image[(g * PART_C_SIZE + j) * B_BANK_DEPTH + kk];
+                  end
+           end
+      end
+   endtask
+
+   // Write the A and B bank images, LOAD_RATIO addresses of every bank per cycle
+   // (word w of bank b at din bits (b * LOAD_RATIO + w) * DATA_WIDTH)
+   task load_images;
+      begin
+         load_a_image();
+         load_b_image();
+      end
+   endtask
+
+   task load_a_image;
+      begin : load_a_image
+         integer addr, b, w;
+
+         start_mult = 0; // Port A belongs to the loader
+         read_en_c = 0;
+         @(posedge clk); #1;
+
+         for (addr = 0; addr < A_BANK_DEPTH; addr = addr + LOAD_RATIO)
+           begin
+              for (b = 0; b < N_BANKS; b = b + 1)
+                begin
+                   addr_a_brams_in[b * ADDR_WIDTH_A +: ADDR_WIDTH_A] = (b << ADDR_WIDTH_A_BANK) | addr;
+                   for (w = 0; w < LOAD_RATIO; w = w + 1)
+                     din_a_brams_in[(b * LOAD_RATIO + w) * DATA_WIDTH +: DATA_WIDTH] = a_image[b * A_BANK_DEPTH + addr + w];
+                end
+              en_a_brams_in = 1;
+              we_a_brams_in = 1;
+              @(posedge clk); #1;
+           end
+         en_a_brams_in = 0;
+         we_a_brams_in = 0;
+      end
+   endtask
+
+   task load_b_image;
+      begin : load_b_image
+         integer addr, b, w;
+
+         start_mult = 0;
+         read_en_c = 0;
+         @(posedge clk); #1;
+
+         for (addr = 0; addr < B_BANK_DEPTH; addr = addr + LOAD_RATIO)
+           begin
+              for (b = 0; b < N_BANKS; b = b + 1)
+                begin
+                   addr_b_brams_in[b * ADDR_WIDTH_B +: ADDR_WIDTH_B] = (b << ADDR_WIDTH_B_BANK) | addr;
+                   for (w = 0; w < LOAD_RATIO; w = w + 1)
+                     din_b_brams_in[(b * LOAD_RATIO + w) * DATA_WIDTH +: DATA_WIDTH] = b_image[b * B_BANK_DEPTH + addr + w];
+                end
+              en_b_brams_in = 1;
+              we_b_brams_in = 1;
+              @(posedge clk); #1;
+           end
+         en_b_brams_in = 0;
+         we_b_brams_in = 0;
+      end
+   endtask
+
+   // Compare the first n_words C addresses with expected_c_mem
+   task verify_c_mem;
+      input integer n_words;
+      begin : verify_c_mem
+         integer addr, element_errors;
+
+         element_errors = 0;
+         read_en_c = 1;
+         for (addr = 0; addr < n_words; addr = addr + 1)
+           begin
+              read_addr_c = addr;
+              @(posedge clk); #1;
+              if (dout_c !== expected_c_mem[addr])
+                begin
+                   $display("Test Case %0d FAIL: C address %0d mismatch! Actual %h, Expected %h",
+                            test_case, addr, dout_c, expected_c_mem[addr]);
+                   element_errors = element_errors + 1;
+                end
+           end
+         read_en_c = 0;
+
+         if (element_errors == 0)
+           begin
+              $display("Test Case %0d PASS (%0d C words)", test_case, n_words);
+              pass_count = pass_count + 1;
+           end
+         else
+           begin
+              fail_count = fail_count + 1;
+              total_errors = total_errors + element_errors;
+           end
+      end
+   endtask
+
+   // Strassen: load block blk (0 = X11, 1 = X12, 2 = X21, 3 = X22) of the full A
+   // or B with load operation op
+   task load_strassen_a;
+      input integer blk;
+      input [1:0]   op;
+      begin : load_strassen_a
+         integer r, c;
+         for (r = 0; r < M; r = r + 1)
+           for (c = 0; c < K; c = c + 1)
+             testbench_A[r][c] = strassen_A[(blk / 2) * M + r][(blk % 2) * K + c];
+         pack_operands();
+         load_op = op;
+         load_a_image();
+         load_op = 0;
+      end
+   endtask
+
+   task load_strassen_b;
+      input integer blk;
+      input [1:0]   op;
+      begin : load_strassen_b
+         integer r, c;
+         for (r = 0; r < K; r = r + 1)
+           for (c = 0; c < N; c = c + 1)
+             testbench_B[r][c] = strassen_B[(blk / 2) * K + r][(blk % 2) * N + c];
+         pack_operands();
+         load_op = op;
+         load_b_image();
+         load_op = 0;
+      end
+   endtask
+
+   // Strassen: the seven block products of a signed 2M x 2K by 2K x 2N product,
+   // operand sums pre-added by the load path and products post-added into the
+   // four C blocks (C11, C12, C21, C22 at C address blk * M * N + i * N + j)
+   task run_strassen_case;
+      begin : run_strassen_case
+         integer r, c, kk, prod;
+         reg signed [ACC_WIDTH-1:0] acc;
+
+         // Operands in [-2^(DATA_WIDTH-2), 2^(DATA_WIDTH-2) - 1], the range in which the
+         // pre-added sums and differences fit DATA_WIDTH; case 0 uses only the two bounds
+         for (r = 0; r < 2 * M; r = r + 1)
+           for (c = 0; c < 2 * K; c = c + 1)
+             strassen_A[r][c] = (test_case == 0) ? (($random & 1) ? (1 << (DATA_WIDTH - 2)) - 1 : -(1 << (DATA_WIDTH - 2))) :
+                                $random % (1 << (DATA_WIDTH - 2));
+         for (r = 0; r < 2 * K; r = r + 1)
+           for (c = 0; c < 2 * N; c = c + 1)
+             strassen_B[r][c] = (test_case == 0) ? (($random & 1) ? (1 << (DATA_WIDTH - 2)) - 1 : -(1 << (DATA_WIDTH - 2))) :
+                                $random % (1 << (DATA_WIDTH - 2));
+         for (r = 0; r < 2 * M; r = r + 1)
+           for (c = 0; c < 2 * N; c = c + 1)
+             begin
+                acc = 0;
+                for (kk = 0; kk < 2 * K; kk = kk + 1)
+                  acc = acc + $signed(strassen_A[r][kk]) * $signed(strassen_B[kk][c]);
+                expected_c_mem[((r / M) * 2 + c / N) * M * N + (r % M) * N + c % N] = acc;
+             end
+
+         for (prod = 0; prod < 7; prod = prod + 1)
+           begin
+              case (prod)
+                0: begin // M1 = (A11 + A22)(B11 + B22): C11 write, C22 write
+                   load_strassen_a(0, 2'd1); load_strassen_a(3, 2'd2);
+                   load_strassen_b(0, 2'd1); load_strassen_b(3, 2'd2);
+                   c_targets = 8'b01_00_00_01;
+                end
+                1: begin // M2 = (A21 + A22) B11: C21 write, C22 subtract
+                   load_strassen_a(2, 2'd1); load_strassen_a(3, 2'd2);
+                   load_strassen_b(0, 2'd1);
+                   c_targets = 8'b11_01_00_00;
+                end
+                2: begin // M3 = A11 (B12 - B22): C12 write, C22 add
+                   load_strassen_a(0, 2'd1);
+                   load_strassen_b(1, 2'd1); load_strassen_b(3, 2'd3);
+                   c_targets = 8'b10_00_01_00;
+                end
+                3: begin // M4 = A22 (B21 - B11): C11 add, C21 add
+                   load_strassen_a(3, 2'd1);
+                   load_strassen_b(2, 2'd1); load_strassen_b(0, 2'd3);
+                   c_targets = 8'b00_10_00_10;
+                end
+                4: begin // M5 = (A11 + A12) B22: C11 subtract, C12 add
+                   load_strassen_a(0, 2'd1); load_strassen_a(1, 2'd2);
+                   load_strassen_b(3, 2'd1);
+                   c_targets = 8'b00_00_10_11;
+                end
+                5: begin // M6 = (A21 - A11)(B11 + B12): C22 add
+                   load_strassen_a(2, 2'd1); load_strassen_a(0, 2'd3);
+                   load_strassen_b(0, 2'd1); load_strassen_b(1, 2'd2);
+                   c_targets = 8'b10_00_00_00;
+                end
+                default: begin // M7 = (A12 - A22)(B21 + B22): C11 add
+                   load_strassen_a(1, 2'd1); load_strassen_a(3, 2'd3);
+                   load_strassen_b(2, 2'd1); load_strassen_b(3, 2'd2);
+                   c_targets = 8'b00_00_00_10;
+                end
+              endcase
+              run_multiplication();
+           end
+         c_targets = 0;
+      end
+   endtask
+
+   // Streaming K: start the job with empty banks and write slice k (A column k,
+   // B row k) to bank address k % STREAM_K_SLOTS once its slot is free
+   task run_stream_case;
+      begin : run_stream_case
+         integer kk, b;
+
+         generate_operands();
+         compute_expected_gemm();
+
+         $display("@%0t: Asserting start_mult, streaming %0d slices through %0d slots...", $time, K, STREAM_K_SLOTS);
+         read_en_c = 0;
+         @(posedge clk); #1;
+         start_mult = 1;
+         for (kk = 0; kk < K; kk = kk + 1)
+           begin
+              while (!slice_free[kk % STREAM_K_SLOTS])
+                begin
+                   @(posedge clk); #1;
+                end
+              for (b = 0; b < N_BANKS; b = b + 1)
+                begin
+                   addr_a_brams_in[b * ADDR_WIDTH_A +: ADDR_WIDTH_A] = (b << ADDR_WIDTH_A_BANK) | (kk % STREAM_K_SLOTS);
+                   din_a_brams_in[b * DATA_WIDTH +: DATA_WIDTH] = (b < M) ? testbench_A[b][kk] : 0;
+                   addr_b_brams_in[b * ADDR_WIDTH_B +: ADDR_WIDTH_B] = (b << ADDR_WIDTH_B_BANK) | (kk % STREAM_K_SLOTS);
+                   din_b_brams_in[b * DATA_WIDTH +: DATA_WIDTH] = (b < N) ? testbench_B[kk][b] : 0;
+                end
+              en_a_brams_in = 1;
+              we_a_brams_in = 1;
+              en_b_brams_in = 1;
+              we_b_brams_in = 1;
+              slice_valid = 1;
+              slice_slot = kk % STREAM_K_SLOTS;
+              @(posedge clk); #1;
+              en_a_brams_in = 0;
+              we_a_brams_in = 0;
+              en_b_brams_in = 0;
+              we_b_brams_in = 0;
+              slice_valid = 0;
+           end
+         wait (mult_done === 1'b1);
+         $display("@%0t: Controller signalled mult_done high.", $time);
+         start_mult = 0;
+         #100;
+      end
+   endtask
+
+   // CONV: output pixels (oy, ox .. ox+M-1) of the N filters in B. The IFM goes
+   // into every A bank; the expected C is the GEMM of its im2col rows and B.
+   task run_conv_case;
+      begin : run_conv_case
+         integer w, b, r, kk, iy, ix;
+
+         generate_operands(); // B: filter f in column f, weight k = (c*kh + ky)*kw + kx
+         for (w = 0; w < CONV_C * CONV_H * CONV_W; w = w + 1)
+           conv_ifm[w] = $random;
+         conv_ox = test_case % 2;          // Odd cases reach the right padding column
+         conv_oy = test_case % CONV_H;     // Case 0 reads the top padding row
+
+         // im2col rows: PE row r, step k reads pixel (oy*S + ky - P, (ox+r)*S + kx - P)
+         for (r = 0; r < M; r = r + 1)
+           for (kk = 0; kk < K; kk = kk + 1)
+             begin
+                iy = conv_oy * CONV_STRIDE + (kk / CONV_KW) % CONV_KH - CONV_PAD;
+                ix = (conv_ox + r) * CONV_STRIDE + kk % CONV_KW - CONV_PAD;
+                if (iy < 0 || iy >= CONV_H || ix < 0 || ix >= CONV_W)
+                  testbench_A[r][kk] = 0;
+                else
+                  testbench_A[r][kk] = conv_ifm[((kk / (CONV_KH * CONV_KW)) * CONV_H + iy) * CONV_W + ix];
+             end
+         compute_expected_gemm();
+
+         pack_operands();
+         for (b = 0; b < N_BANKS; b = b + 1)
+           for (w = 0; w < CONV_C * CONV_H * CONV_W; w = w + 1)
+             a_image[b * A_BANK_DEPTH + w] = conv_ifm[w];
+         load_images();
+         conv_en = 1;
+         run_multiplication();
+         conv_en = 0;
+      end
+   endtask
+
+   // AGU: a default job writes C0 = A * B, then an AGU job over the same banks
+   // multiplies the even (even cases) or odd K columns of A and rows of B and
+   // writes the 3 x 2 corner of that product, transposed, from C address 8
+   // (C[i][j] at 8 + i + j * M). The other C0 words must be left untouched.
+   task run_agu_case;
+      begin : run_agu_case
+         integer r, c, t, kk;
+
+         generate_operands();
+         pack_operands();
+         compute_expected_gemm();
+         load_images();
+         run_multiplication();
+
+         agu_a_base = test_case % 2;
+         agu_a_stride_r = 0; // Row r is bank r, address k
+         agu_a_stride_k = 2;
+         agu_b_base = test_case % 2;
+         agu_b_stride_c = 0; // Column c is bank c, address k
+         agu_b_stride_k = 2;
+         agu_c_base = 8;
+         agu_c_stride_r = 1;
+         agu_c_stride_c = M;
+         agu_k_len = K / 2;
+         agu_m_len = 3;
+         agu_n_len = 2;
+         for (r = 0; r < 3; r = r + 1)
+           for (c = 0; c < 2; c = c + 1)
+             begin
+                expected_c_mem[8 + r + c * M] = 0;
+                for (t = 0; t < K / 2; t = t + 1)
+                  begin
+                     kk = test_case % 2 + 2 * t;
+                     expected_c_mem[8 + r + c * M] = expected_c_mem[8 + r + c * M] + testbench_A[r][kk] * testbench_B[kk][c];
+                  end
+             end
+         agu_en = 1;
+         run_multiplication();
+         agu_en = 0;
+      end
+   endtask
+
+   // SKEW: store A and B diagonally (S[r][c] in bank (r + c) % N_BANKS at address
+   // (r / N_BANKS) * C + c) and run one job per transpose_a/transpose_b setting
+   // over the same banks: A B, A^T B, A B^T and A^T B^T (square M = K = N)
+   task run_skew_case;
+      begin : run_skew_case
+         integer r, c, kk, job;
+
+         generate_operands();
+         clear_images();
+         for (r = 0; r < M; r = r + 1)
+           for (c = 0; c < K; c = c + 1)
+             a_image[((r + c) % N_BANKS) * A_BANK_DEPTH + (r / N_BANKS) * K + c] = testbench_A[r][c];
+         for (r = 0; r < K; r = r + 1)
+           for (c = 0; c < N; c = c + 1)
+             b_image[((r + c) % N_BANKS) * B_BANK_DEPTH + (r / N_BANKS) * N + c] = testbench_B[r][c];
+         load_images();
+
+         for (job = 0; job < 4; job = job + 1)
+           begin
+              transpose_a = job % 2;
+              transpose_b = job / 2;
+              for (r = 0; r < M; r = r + 1)
+                for (c = 0; c < N; c = c + 1)
+                  begin
+                     expected_c_mem[r * N + c] = 0;
+                     for (kk = 0; kk < K; kk = kk + 1)
+                       expected_c_mem[r * N + c] = expected_c_mem[r * N + c] +
+                                                   (transpose_a ? testbench_A[kk][r] : testbench_A[r][kk]) *
+                                                   (transpose_b ? testbench_B[c][kk] : testbench_B[kk][c]);
+                  end
+              $display("@%0t: SKEW job, transpose_a = %0d, transpose_b = %0d", $time, transpose_a, transpose_b);
+              run_multiplication();
+              verify_c_mem(M * N);
+           end
+         transpose_a = 0;
+         transpose_b = 0;
+      end
+   endtask
+
+   // One generated case of the selected configuration
+   task run_generated_case;
+      begin
+         if (STRASSEN)
+           begin
+              run_strassen_case();
+              verify_c_mem(4 * M * N);
+           end
+         else if (STREAM_K_SLOTS > 0)
+           begin
+              run_stream_case();
+              verify_c_mem(M * N);
+           end
+         else if (CONV)
+           begin
+              run_conv_case();
+              verify_c_mem(M * N);
+           end
+         else if (AGU)
+           begin
+              run_agu_case();
+              verify_c_mem(M * N);
+           end
+         else if (SKEW)
+           run_skew_case(); // Checks C after each of its four jobs
+         else
+           run_gemm_case();
+      end
+   endtask
+
+   // One GEMM case (partitioned core: a batch of jobs on even cases)
+   task run_gemm_case;
+      begin
+         generate_operands();
+         // Partitioned core: even cases run a batch, odd cases use the whole array
+         partition = (PE_PART_ROWS * PE_PART_COLS > 1) && (test_case % 2 == 0);
+         if (partition)
+           begin
+              pack_partitioned_batch();
+           end
+         else
+           begin
+              pack_operands();
+              compute_expected_gemm();
+           end
+         load_images();
+         run_multiplication();
+         verify_c_mem(M * N);
+      end
+   endtask
+
+
    // --------------------------------------------------------------------------
    // --- Main Initial Block ---
    // --------------------------------------------------------------------------
@@ -559,8 +1229,33 @@ module top_tb;
 
         // Initialize all testbench inputs to a known state at time 0
         clk = 0;
+        clk2x = 1;
         rst_n = 0; // Start with reset asserted
         start_mult = 0;
+        precision = 0;
+        partition = 0;
+        load_op = 0;
+        c_targets = 0;
+        slice_valid = 0;
+        slice_slot = 0;
+        conv_en = 0;
+        conv_ox = 0;
+        conv_oy = 0;
+        agu_en = 0;
+        agu_a_base = 0;
+        agu_a_stride_r = 0;
+        agu_a_stride_k = 0;
+        agu_b_base = 0;
+        agu_b_stride_c = 0;
+        agu_b_stride_k = 0;
+        agu_c_base = 0;
+        agu_c_stride_r = 0;
+        agu_c_stride_c = 0;
+        agu_k_len = 0;
+        agu_m_len = 0;
+        agu_n_len = 0;
+        transpose_a = 0;
+        transpose_b = 0;
         read_en_c = 0;
         read_addr_c = 0;
 
@@ -625,10 +1320,21 @@ module top_tb;
            #100;
         end // for (test_case = 0; test_case < NUM_TEST_CASES; test_case = test_case + 1)
 
+      for (test_case = 0; test_case < NUM_GEN_CASES; test_case = test_case + 1)
+        begin
+           $display("\n===================================================");
+           $display("@%0t Generated Test Case %0d of %0d (%0s)", $time, test_case, NUM_GEN_CASES, CONFIG);
+           $display("===================================================");
+           run_generated_case();
+        end
+
       $display("--------------------------------------------------");
       $display(" Pass cases : %d", pass_count);
       $display(" Fail cases : %d", fail_count);
-        $display(" Testbench FAILED with %0d errors!", total_errors);
+        if (fail_count == 0)
+          $display(" Testbench PASSED");
+        else
+          $display(" Testbench FAILED with %0d errors!", total_errors);
         $display("--------------------------------------------------");
 
         #100; // Wait before finishing